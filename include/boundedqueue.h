@@ -0,0 +1,12 @@
+#pragma once
+
+// Fixed-capacity lock-free queue of pointers, safe for any number of
+// producers and consumers. Push and pop never block; callers decide how to
+// wait when the queue is full or empty.
+typedef struct BoundedQueue BoundedQueue;
+
+BoundedQueue *boundedQueueCreate(int capacity); // rounded up to a power of two
+void boundedQueueDestroy(BoundedQueue *queue);
+
+int boundedQueuePush(BoundedQueue *queue, void *item); // 0 when full
+int boundedQueuePop(BoundedQueue *queue, void **item); // 0 when empty
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <types.h>
+#include <projection.h>
+
+// Lines may overhang the viewport by this many pixels before being culled,
+// enough to cover the widest stroke.
+#define CLIP_MARGIN 8.0f
+
+typedef struct {
+    int visible; // edges written out
+    int clipped; // of those, shortened at a near plane or the viewport margin
+    int culled;  // behind the camera or wholly outside the viewport
+} ClipStats;
+
+// Clipping stage between projection and line emission. Runs over every
+// edge of mesh (mesh->edges, local vertex indices) once its vertices have
+// been projected into projected:
+//  - edges with both ends on screen in front of the camera pass through;
+//  - edges wholly outside the viewport or behind a near plane are culled;
+//  - edges crossing the 3D near plane or a hyper-near plane are clipped in
+//    camera space, and edges leaving the viewport are cut to it plus
+//    CLIP_MARGIN; each end either moves gets a new endpoint, written to
+//    created and referenced as createdBase + k.
+// Surviving edges go to out as pairs of vertexBase + local index, and
+// every endpoint they reference lies within CLIP_MARGIN of the viewport.
+// offset, when not NULL, is the xyz placement added after the hyper
+// divides, as instances do. created and out each need room for
+// 2 * mesh->edgeCount entries. codes is scratch for mesh->vertexCount
+// outcodes, kept by the caller between frames; when NULL every edge passes
+// through unclipped.
+ClipStats clipEdges(const Camera *cam, int perspective, const EdgeList *mesh, const float *offset,
+                    const Proj *projected, int vertexBase, Proj *created, int createdBase, int *out,
+                    unsigned char *codes);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <types.h>
+
+// Unit n-cube centred on the origin: 2^n vertices and n * 2^(n-1) edges.
+// The tables for every dimension are generated at build time into read-only
+// data, so this is a lookup that never allocates and the result can be
+// shared by any number of threads and instances. It must not be written to
+// or freed. Dimensions outside 3..MAX_DIMENSION give an empty list.
+const EdgeList *cubeMesh(int dimension);
+void freeEdgeList(EdgeList *list);
+
+// Vertex buffer shaped like rest for its transformed copy. The edges are
+// rest's own, so release it with freeVertexData(pose.data) alone.
+EdgeList createPoseBuffer(const EdgeList *rest);
@@ -0,0 +1,26 @@
+#pragma once
+
+enum { EXPORT_FORMAT_Y4M, EXPORT_FORMAT_RGBA };
+
+// Windowless animation export: renders a fixed number of frames at a fixed
+// timestep with the software rasterizer and streams them to disk. Geometry,
+// rasterization and writing run as pipeline stages joined by bounded
+// lock-free queues, so memory use does not grow with the frame count.
+typedef struct {
+    const char *path; // "-" streams to stdout
+    int format;
+    int frames;
+    float dt;
+    int dimension;
+    int perspective;
+    int width, height;
+    int workers;    // rasterizer stages, 0 for every core not taken by geometry and writer
+    int queueDepth; // frames in flight, 0 for twice the workers
+    const char *mesh; // polytope file replacing the cube, sets the dimension
+    const char *trace; // Chrome trace of the pipeline stages, if set
+} ExportOptions;
+
+// Returns 1 when argv asks for an export (filling opts), 0 when it does not
+// and -1 on malformed arguments.
+int parseExportArgs(int argc, char **argv, ExportOptions *opts);
+int runExport(const ExportOptions *opts);
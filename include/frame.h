@@ -0,0 +1,18 @@
+#pragma once
+
+#include <types.h>
+#include <projection.h>
+#include <orientation.h>
+
+// Per-frame geometry stages, shared by the window loop and headless runs.
+
+// Builds the combined rotation for dim into matrix (dim * dim floats).
+void frameComposeRotation(const AngleList *angles, int dim, float *matrix);
+
+// Turns the orientation by dt * radiansPerSecond in every plane whose
+// rotate flag is set.
+void frameAdvance(Orientation *orientation, const int *rotate, float dt, float radiansPerSecond);
+
+// Projects all vertices with the perspective chain for their dimension, or
+// orthographically when perspective is 0.
+void frameProject(const Camera *cam, int perspective, const EdgeList *verts, Proj *out);
@@ -0,0 +1,30 @@
+#pragma once
+
+// Where the emit stage sends its lines
+enum { HEADLESS_SINK_NULL, HEADLESS_SINK_NUKLEAR, HEADLESS_SINK_RASTER, HEADLESS_SINK_GL };
+
+// Windowless benchmark of the per-frame pipeline: runs a fixed number of
+// frames at a fixed timestep and prints per-stage timings as JSON.
+typedef struct {
+    int frames;
+    float dt;
+    int dimension;
+    int perspective;
+    int sink;
+    int threads;        // software rasterizer and instance threads, 0 for every core
+    int instances;      // hypercubes of dimension 3..dimension, 0 for the single cube
+    float cameraDistance;
+    const char *mesh;   // polytope file replacing the cube, sets the dimension
+    int width, height;
+    const char *output; // JSON destination, stdout when NULL
+    const char *frameOutput; // PPM of the last raster or gl frame, if set
+    const char *trace;       // Chrome trace of every frame's stages, if set
+    int slice;          // project the cross-section at x[n-1] = sliceOffset instead
+    float sliceOffset;
+    float lodCell;      // merge edges on the same segment of this grid, 0 for off
+} HeadlessOptions;
+
+// Returns 1 when argv asks for a headless run (filling opts), 0 when it
+// does not and -1 on malformed arguments.
+int parseHeadlessArgs(int argc, char **argv, HeadlessOptions *opts);
+int runHeadless(const HeadlessOptions *opts);
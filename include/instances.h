@@ -0,0 +1,51 @@
+#pragma once
+
+#include <types.h>
+#include <projection.h>
+#include <threadpool.h>
+#include <clip.h>
+
+// A scene of many independently rotating hypercubes. Per-instance state
+// lives in parallel arrays, instances of one dimension share a single rest
+// pose from cubeMesh, and the transformed vertices, projections and edge
+// indices of every instance are packed into contiguous buffers so the whole
+// scene is emitted as one batch.
+typedef struct {
+    int count;
+    int *dimension;
+    float *position;   // xyz per instance, added once the instance is projected down to 3D
+    float *scale;
+    AngleList *angles;
+    AngleList *velocity; // radians per second per plane
+    int *dataOffset;   // start of the instance's SoA block in world
+    int *vertexOffset; // first entry of the instance in projected
+    int *edgeOffset;   // first edge of the instance in the whole scene
+    ClipStats *clip;   // per instance, from the last instanceSetProject
+
+    float *world;      // transformed vertices, one padded SoA block per instance
+    Proj *projected;   // vertexCount projections, then endpoints made by clipping
+    int vertexCount;
+    int *edges;        // visible edges after the last instanceSetProject, pairs indexing projected
+    unsigned char *codes; // clipping outcodes, one per projected vertex
+    int edgeCount;
+    int totalEdgeCount;
+    int clippedEdges, culledEdges;
+
+    EdgeList rest[MAX_DIMENSION + 1]; // shared rest poses by dimension
+} InstanceSet;
+
+// Lays count instances out on a grid facing the camera with dimensions
+// spread over [minDim, maxDim] and seeded random spins. Returns 0 when
+// allocation fails, leaving the set empty.
+int instanceSetCreate(InstanceSet *set, int count, int minDim, int maxDim, unsigned seed);
+void instanceSetFree(InstanceSet *set);
+
+// Rotates every instance from its rest pose into world, then advances its
+// angles by dt. Instances are split across the pool with work stealing
+// since their cost grows with 2^dimension.
+void instanceSetTransform(InstanceSet *set, ThreadPool *pool, float dt);
+
+// Projects each instance to 3D about its own origin, moves it to its
+// position, projects the result to the screen and clips its edges. The
+// survivors are then packed into edges / edgeCount.
+void instanceSetProject(InstanceSet *set, ThreadPool *pool, const Camera *cam, int perspective);
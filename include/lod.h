@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <types.h>
+
+// Default grid for edgeLodReduce: endpoints closer than a pixel are treated
+// as one.
+#define EDGE_LOD_CELL 1.0f
+
+// Screen-space level of detail between clipping and line emission. At
+// higher dimensions many edges land on the same segment; after snapping
+// endpoints to a grid of cell pixels only one edge per distinct segment is
+// kept, and edges whose endpoints share a cell are dropped. Drawing then
+// costs as much as the distinct visible segments, not the raw edge count.
+// Key and stamp share a slot so a probe touches one cache line
+typedef struct {
+    uint64_t key;
+    uint32_t stamp;     // occupied when it matches the set's stamp
+} EdgeLodSlot;
+
+typedef struct {
+    EdgeLodSlot *slots; // open-addressed set of snapped segments
+    int capacity;       // power of two, at least twice the edges reduced
+    uint32_t stamp;
+    uint32_t *cells;    // snapped vertices
+    int cellCapacity;
+} EdgeLod;
+
+typedef struct {
+    int submitted;  // edges in
+    int drawn;      // distinct segments written out
+    int merged;     // repeats of a segment already written
+    int degenerate; // shorter than a cell
+} LodStats;
+
+// Reduces edgeCount edges (pairs of indices into projected) into out, which
+// may be edges itself. Indices from vertexCount on are endpoints made by
+// clipping. Edges with an endpoint more than 32767 cells from the origin
+// are off the grid and pass through. The set is reused between calls and
+// grows as needed; if it cannot, the edges pass through unchanged.
+LodStats edgeLodReduce(EdgeLod *lod, const Proj *projected, int vertexCount, const int *edges, int edgeCount,
+                       float cell, int *out);
+void edgeLodFree(EdgeLod *lod);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <types.h>
+
+// Rotation composition: matrices are row-major dim x dim and points are
+// column vectors, so a rotation applied later is multiplied on the left.
+
+void matrixIdentityN(float *m, int dim);
+
+// Left-multiplies m by the Givens rotation in plane (a, b) without building
+// the full rotation matrix; only rows a and b of m are touched.
+void matrixRotatePlaneN(float *m, int dim, int a, int b, float angle);
+
+// Single-plane matrices used by the original per-plane passes, and the
+// in-place scalar transform they were applied with.
+void getRotationMatrix3D(AngleList angle, float out[9], int axisType);
+void getRotationMatrix4D(AngleList angle, float out[16], int planeType);
+void matrixMultiplyN(const float *m, EdgeList *list);
+
+// Rotation planes of an n-cube: n(n-1)/2 of them, indexed lexicographically.
+int planeCount(int dim);
+int planeIndex(int dim, int a, int b);
+void planeAxes(int dim, int plane, int *a, int *b);
+
+// Full dim x dim rotation matrix for a single plane.
+void getRotationMatrixN(const AngleList *angle, float *out, int dim, int plane);
+
+// Combined rotation for every active plane. 3D keeps the visual X, Y, Z
+// order of the original controls; N-D applies planes in index order, which
+// for 4D matches the old per-plane getRotationMatrix4D passes.
+void composeRotation3D(const AngleList *angle, float out[9]);
+void composeRotationN(const AngleList *angle, float *out, int dim);
+
+// SoA vertex storage helpers. Strides are rounded up to a whole number of
+// the widest vector so the transform kernels never need a tail loop.
+#define VERTEX_ALIGNMENT 64
+#define VERTEX_STRIDE_MULTIPLE 16
+
+int vertexStrideFor(int vertexCount);
+float *allocVertexData(int dimension, int stride); // zeroed and aligned
+void freeVertexData(float *data);
+
+// dst vertices = m * src vertices, in one pass. src stays untouched so it
+// can hold the immutable rest pose; dst must have the same vertex count
+// and stride and must not alias src. The SSE2/AVX2/AVX-512 kernel is
+// picked by CPUID on first use.
+void transformVerticesN(const float *m, const EdgeList *src, EdgeList *dst);
+const char *transformBackendName(void);
@@ -0,0 +1,12 @@
+#pragma once
+
+// Nuklear feature set; every translation unit that includes nuklear.h must
+// see the same configuration as the one holding NK_IMPLEMENTATION.
+#define NK_INCLUDE_FIXED_TYPES
+#define NK_INCLUDE_STANDARD_IO
+#define NK_INCLUDE_STANDARD_VARARGS
+#define NK_INCLUDE_DEFAULT_ALLOCATOR
+
+#define NK_INCLUDE_FONT_BAKING
+#define NK_INCLUDE_DEFAULT_FONT
+#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <types.h>
+
+// Accumulated rotation state. Instead of rebuilding the matrix from
+// ever-growing absolute angles, each frame's small per-plane increments are
+// folded into a unit quaternion (3D), a left/right isoclinic quaternion pair
+// (4D, p -> left * p * right) or an orthonormal matrix (5D and up), which is
+// renormalized every few steps so rounding cannot accumulate.
+typedef struct {
+    int dimension;
+    int steps;                                   // advances since the last renormalization
+    float q[4];                                  // 3D, (w, x, y, z)
+    float left[4], right[4];                     // 4D, axes X, Y, Z, W as (w, x, y, z)
+    float matrix[MAX_DIMENSION * MAX_DIMENSION]; // 5D and up
+} Orientation;
+
+void orientationReset(Orientation *o, int dim);
+
+// Rotates by delta->plane[p] radians in every plane, with the plane order
+// and sign conventions of composeRotation3D / composeRotationN.
+void orientationAdvance(Orientation *o, const AngleList *delta);
+
+// Row-major dim x dim rotation matrix for the current orientation.
+void orientationMatrix(const Orientation *o, float *matrix);
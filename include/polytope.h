@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <types.h>
+
+// On-disk wireframe, laid out so a read-only mapping of the file can be
+// used as an EdgeList in place: a 64-byte header, then the vertices in the
+// padded SoA layout of allocVertexData (dimension rows of stride floats,
+// 64-byte aligned), then edgeCount pairs of int32 vertex indices. All
+// fields are little-endian.
+#define POLYTOPE_MAGIC "CUBEPOLY"
+#define POLYTOPE_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dimension;
+    uint32_t vertexCount;
+    uint32_t edgeCount;
+    uint32_t stride;      // vertexStrideFor(vertexCount)
+    uint32_t reserved;
+    uint64_t dataOffset;  // from the start of the file
+    uint64_t edgesOffset;
+    char name[16];        // NUL-padded, e.g. "600-cell"
+} PolytopeHeader;
+
+// A mapped polytope file. mesh points straight into the mapping, which is
+// read-only: use it as a rest pose and transform into a separate buffer.
+typedef struct {
+    EdgeList mesh;
+    const PolytopeHeader *header;
+    void *base;
+    size_t size;
+} Polytope;
+
+// Maps path and checks its header, offsets and edge indices. Returns 0 and
+// prints why when the file cannot be used.
+int polytopeOpen(Polytope *poly, const char *path);
+void polytopeClose(Polytope *poly);
+
+// Writes mesh (any stride) to path in the format above.
+int polytopeWrite(const EdgeList *mesh, const char *name, const char *path);
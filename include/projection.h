@@ -0,0 +1,44 @@
+#pragma once
+
+#include <types.h>
+
+// Per-point projections
+Proj projectOrthoN(const float *pt, int dimension, float screenW, float screenH, float scaleFactor);
+Proj projectPerspective3D(float x, float y, float z, float screenW, float screenH, float camDistance, float fovY);
+void projectHyper4Dto3D(const float *pt4, int dim, float screenW, float screenH, float cam4DDistance, float fov4D, Proj *out, float cameraDistance, float fovY);
+void projectHyperNto3D(const float *pt, int dim, float screenW, float screenH, float camNDistance, float fovN, Proj *out, float cameraDistance, float fovY);
+void flatten4Dto3D(const float *pt4, float out3[3]);
+void flattenNto3D(const float *pt, int dim, float out3[3]);
+
+// Everything the projections derive from the window and UI parameters,
+// worked out once by cameraUpdate instead of once per point.
+typedef struct {
+    float screenW, screenH;
+    float halfW, halfH;
+    float orthoScaleX, orthoScaleY; // screen size * scaleFactor
+    float f;                        // 1 / tan(fovY / 2)
+    float fOverAspect;
+    float cameraDistance;
+    float hyperF;                   // 1 / tan(hyperFov / 2)
+    float hyperDistance;
+    float invAspect;
+} Camera;
+
+#define CAMERA_NEAR 0.01f
+
+void cameraUpdate(Camera *cam, float screenW, float screenH, float scaleFactor, float cameraDistance, float fovY, float hyperCamDistance, float hyperFov);
+
+// Batch projections of every vertex in verts into out[vertexCount]. They
+// stream over the SoA axis planes with no per-point branching, so the
+// compiler can vectorize them.
+void projectOrthoBatch(const Camera *cam, const EdgeList *verts, Proj *out);
+void projectPerspectiveBatch(const Camera *cam, const EdgeList *verts, Proj *out);
+void projectHyperBatch(const Camera *cam, const EdgeList *verts, Proj *out);
+
+// Applies the chained perspective divides of axes 3.. without the final 3D
+// step, writing three SoA planes of verts->stride floats into out3.
+void collapseHyperBatch(const Camera *cam, const EdgeList *verts, float *out3);
+
+// Collapses axes 3.. into z, writing three SoA planes of verts->stride
+// floats into out3.
+void flattenBatch(const EdgeList *verts, float *out3);
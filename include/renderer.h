@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <types.h>
+
+// RGBA8 pixels, row-major from the top-left, packed with red in the low
+// byte so the buffer can be uploaded as GL_RGBA / GL_UNSIGNED_BYTE.
+typedef struct {
+    int width, height;
+    uint32_t *pixels;
+} Framebuffer;
+
+#define RGBA(r, g, b, a) ((uint32_t)(r) | ((uint32_t)(g) << 8) | ((uint32_t)(b) << 16) | ((uint32_t)(a) << 24))
+
+// Tiled CPU wireframe rasterizer. Edges are binned into screen tiles, and
+// each tile is cleared and drawn with anti-aliased thick lines on one pool
+// thread, so tiles never share pixels and need no locking.
+typedef struct SoftwareRenderer SoftwareRenderer;
+
+SoftwareRenderer *softwareRendererCreate(int width, int height, int threads);
+void softwareRendererDestroy(SoftwareRenderer *renderer);
+int softwareRendererResize(SoftwareRenderer *renderer, int width, int height); // 0 on failure
+
+// Draws edgeCount edges (pairs of indices into verts) over a cleared
+// background. Returns the number of edge/tile pairs that were rasterized.
+int softwareRendererDraw(SoftwareRenderer *renderer, const Proj *verts, const int *edges, int edgeCount,
+                         float thickness, uint32_t color, uint32_t background);
+
+const Framebuffer *softwareRendererFramebuffer(const SoftwareRenderer *renderer);
+
+// Binary PPM dump (alpha dropped) for checking frames without a display.
+int framebufferWritePPM(const Framebuffer *fb, const char *path);
+
+// GPU wireframe renderer for the GL 3.3 core context. Each draw streams only
+// the projected positions. The edge list stays on the GPU while a frame's
+// edges are the complete topology, and a geometry shader expands each line
+// into an anti-aliased quad, so submission cost follows the vertex count.
+// Every call needs the creating context current.
+typedef struct LineRenderer LineRenderer;
+
+LineRenderer *lineRendererCreate(void); // NULL if the shaders fail to build
+void lineRendererDestroy(LineRenderer *renderer);
+
+void lineRendererClear(LineRenderer *renderer, uint32_t background);
+// Draws edgeCount edges (pairs of indices below vertexCount) into a
+// width x height pixel viewport. verts and thickness are in window units of
+// pixelScale pixels each (above 1 on HiDPI screens), so strokes and their AA
+// ramp come out in device pixels. complete says that edges is the whole
+// topology identified by key (nothing clipped or culled). Such a list is
+// uploaded once per key, and any other list is streamed with the frame.
+// Returns the bytes uploaded.
+size_t lineRendererDraw(LineRenderer *renderer, const Proj *verts, int vertexCount, const int *edges, int edgeCount,
+                        int complete, unsigned key, float width, float height, float pixelScale, float thickness,
+                        uint32_t color);
+
+// Redirects drawing into an offscreen RGBA8 target for runs without a
+// visible window, and reads it back top-down into fb (same size).
+int lineRendererOffscreen(LineRenderer *renderer, int width, int height);
+int lineRendererReadPixels(LineRenderer *renderer, Framebuffer *fb);
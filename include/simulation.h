@@ -0,0 +1,80 @@
+#pragma once
+
+#include <types.h>
+#include <polytope.h>
+
+// Fixed-timestep geometry thread for the window. It advances the rotation
+// in steps of exactly one tick period, transforms and projects the scene and
+// publishes each result as a snapshot through a triple buffer, so a stalled
+// swap never holds back the simulation and a heavy N-D transform never
+// holds back presentation. Inputs travel the other way through a second
+// triple buffer, so neither thread takes a lock while both are busy.
+#define SIMULATION_DEFAULT_TICK_RATE 120.0
+// Ticks run back to back at most this many at a time; beyond that the
+// simulation drops time instead of falling further behind
+#define SIMULATION_MAX_CATCHUP 4
+
+// Everything besides the geometry that feeds the projection
+typedef struct {
+    int projectionType;
+    float scaleFactor, cameraDistance, fovY, hyperCamDistance, hyperFov;
+    int width, height;
+    int slice;          // show the cross-section at x[n-1] = sliceOffset (4D and up)
+    float sliceOffset;
+    int lod;            // merge edges that land on the same screen segment
+} ViewState;
+
+typedef struct {
+    int dimension;
+    int instanceCount;  // 0 shows the single mesh
+    int rotate[MAX_PLANES];
+    float radiansPerSecond;
+    ViewState view;
+    unsigned sequence;  // assigned by simulationSetInput
+} SimulationInput;
+
+// One published tick. Vertex indices are stable while generation is
+// unchanged, so two snapshots of one generation can be blended.
+typedef struct {
+    Proj *projected;    // vertexCount projections, then endpoints made by clipping
+    int *edges;         // visible edges, pairs indexing projected
+    int vertexCount;
+    int edgeCount;
+    int totalEdgeCount;
+    int clippedEdges, culledEdges;
+    int sliced;         // a cross-section: the edges change from tick to tick
+    int lodMerged, lodDegenerate; // visible edges the level of detail left out
+    int dimension;
+    int instanceCount;  // instances actually built
+    unsigned generation;
+    int animating;
+    double time;        // when the state was current, on the timerNow clock
+    unsigned inputSequence; // newest input the snapshot reflects
+    float tickMs;       // transform and project time of the tick
+    float lateMs;       // how far behind schedule the tick started
+    int droppedTicks;   // total so far
+    int projectedCapacity, edgeCapacity;
+} SimulationSnapshot;
+
+typedef struct Simulation Simulation;
+
+// Starts the simulation thread. meshes are the rest poses by dimension as in
+// main and must outlive it. wake, if set, is called from the simulation
+// thread after every publish so an idle render loop can pick it up.
+Simulation *simulationCreate(const Polytope *meshes, double tickRate, void (*wake)(void));
+void simulationDestroy(Simulation *sim);
+double simulationTickPeriod(const Simulation *sim);
+
+// Publishes input to the simulation; returns its sequence number.
+unsigned simulationSetInput(Simulation *sim, const SimulationInput *input);
+// Compares everything but the sequence number.
+int simulationInputEqual(const SimulationInput *a, const SimulationInput *b);
+
+// Render side. simulationAcquire swaps in the newest snapshot, keeping the
+// vertices of the one it replaces, and returns 1 when there was a new one.
+int simulationAcquire(Simulation *sim);
+const SimulationSnapshot *simulationCurrent(Simulation *sim);
+// The current snapshot's projections, blended from the previous snapshot
+// toward the current one for renderTime. Returns the snapshot's own array
+// when there is nothing to blend.
+const Proj *simulationInterpolate(Simulation *sim, double renderTime);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <types.h>
+
+// Cross-section of a rotated n-cube by the hyperplane x[n-1] = offset: an
+// (n-1)-dimensional polytope that is projected like any other mesh. Every
+// mesh edge yields one slice vertex, where it meets the hyperplane or,
+// for an edge that does not cross it, the endpoint nearer to it. Slice
+// vertex indices therefore never change between cuts, and two cuts of one
+// mesh can be blended. Two crossing points are joined by a slice edge when
+// their mesh edges bound a common square face. The face table is built
+// once per mesh.
+typedef struct {
+    int dimension;      // of the mesh being cut
+    int edgeCount;      // of the mesh
+    int *from, *to;     // mesh edge endpoints, split for the batch pass
+    int faceCount;
+    int *faces;         // four mesh edges per square face
+    float *t;           // per mesh edge, where it meets the hyperplane
+    float *ends;        // scratch: both endpoint values of every edge on one axis
+    unsigned char *crossing;
+    EdgeList slice;     // dimension - 1; vertex e lies on mesh edge e
+} Slicer;
+
+// Builds the face table of mesh, which needs n-cube connectivity (vertex
+// indices whose bits are the coordinates, as in cubeMesh) and dimension 4
+// or more. Returns 0 otherwise or when allocation fails, leaving s empty.
+int slicerCreate(Slicer *s, const EdgeList *mesh);
+void slicerFree(Slicer *s);
+
+// Cuts pose, a transformed copy of the mesh s was built for, into s->slice.
+// Returns the number of slice edges.
+int slicerCut(Slicer *s, const EdgeList *pose, float offset);
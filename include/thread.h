@@ -0,0 +1,37 @@
+#pragma once
+
+// Thin portable wrapper over Win32 and pthreads for the worker pools and
+// pipeline stages.
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+typedef HANDLE Thread;
+typedef SRWLOCK Mutex;
+typedef CONDITION_VARIABLE CondVar;
+#else
+#include <pthread.h>
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t CondVar;
+#endif
+
+typedef void (*ThreadFn)(void *arg);
+
+int threadCreate(Thread *thread, ThreadFn fn, void *arg); // 0 on success
+void threadJoin(Thread thread);
+void threadYield(void);
+void threadSleepMicros(int micros);
+int hardwareThreadCount(void);
+
+void mutexInit(Mutex *mutex);
+void mutexDestroy(Mutex *mutex);
+void mutexLock(Mutex *mutex);
+void mutexUnlock(Mutex *mutex);
+
+void condInit(CondVar *cond);
+void condDestroy(CondVar *cond);
+void condWait(CondVar *cond, Mutex *mutex);
+void condSignal(CondVar *cond);
+void condBroadcast(CondVar *cond);
@@ -0,0 +1,23 @@
+#pragma once
+
+// Fixed pool of worker threads running parallel-for style jobs. The
+// calling thread takes part in every job, so a pool of N threads starts
+// N - 1 workers.
+typedef struct ThreadPool ThreadPool;
+
+typedef void (*ThreadTask)(void *ctx, int index);
+
+ThreadPool *threadPoolCreate(int threads); // threads <= 0 uses every core
+void threadPoolDestroy(ThreadPool *pool);
+int threadPoolSize(const ThreadPool *pool);
+
+// Calls task(ctx, i) for every i in [0, count) across the pool and returns
+// once all of them have finished. Indices are handed out dynamically, so
+// uneven tasks balance themselves.
+void threadPoolRun(ThreadPool *pool, ThreadTask task, void *ctx, int count);
+
+// Like threadPoolRun, but [0, count) starts out split into one contiguous
+// range per thread. Each thread works through its own range grain indices
+// at a time and, once it runs dry, steals the back half of another thread's
+// remaining range. Suits tasks with uneven cost whose neighbours share data.
+void threadPoolRunStealing(ThreadPool *pool, ThreadTask task, void *ctx, int count, int grain);
@@ -0,0 +1,5 @@
+#pragma once
+
+// Monotonic clock in seconds that works without a GLFW context, for the
+// headless and benchmark paths.
+double timerNow(void);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+// In-process zone tracing. Each thread records completed zones into its own
+// preallocated ring (the newest TRACE_EVENTS_PER_THREAD survive), so a zone
+// costs two cycle-counter reads and one store and needs no locking. Zones
+// are only recorded while tracing is enabled; otherwise traceBegin and
+// traceEnd return after one flag check.
+#define TRACE_EVENTS_PER_THREAD (1 << 16)
+
+typedef struct {
+    const char *name; // must outlive the trace, normally a string literal
+    uint64_t start;   // 0 when tracing was off at traceBegin
+} TraceZone;
+
+void traceSetEnabled(int enabled);
+int traceEnabled(void);
+
+TraceZone traceBegin(const char *name);
+void traceEnd(const TraceZone *zone);
+
+// Labels the calling thread in the written trace.
+void traceSetThreadName(const char *name);
+
+// Releases the calling thread's ring to the next thread that records. The
+// zones already in it keep the exited thread's name and id in the written
+// trace until they are overwritten. Threads started by threadCreate call it
+// on exit.
+void traceThreadExit(void);
+
+// Writes every recorded zone as Chrome trace_event JSON (load it in
+// chrome://tracing or Perfetto). It may run while other threads record;
+// zones they overwrite during the copy are left out. Returns 0 on failure.
+int traceWriteChrome(const char *path);
+
+// The last TRACE_FRAME_HISTORY frame times, for the frame-time panel.
+#define TRACE_FRAME_HISTORY 512
+
+typedef struct {
+    float ms[TRACE_FRAME_HISTORY];
+    int count, next;
+} FrameTimes;
+
+void frameTimesAdd(FrameTimes *times, float ms);
+// Copies the recorded frame times into sorted in ascending order and
+// returns how many there are.
+int frameTimesSorted(const FrameTimes *times, float *sorted);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdatomic.h>
+
+// Lock-free single-producer single-consumer triple buffer over three
+// caller-owned slots, indexed 0..2. The producer always has a back slot to
+// fill and the consumer a front slot to read; publishing swaps the back slot
+// with the middle one and acquiring swaps the middle one into the front, so
+// neither side ever waits and the consumer always gets the newest slot.
+// Intermediate slots published between two acquires are skipped.
+typedef struct {
+    atomic_uint middle; // slot index, plus TRIPLE_BUFFER_FRESH once published
+    int back;           // producer only
+    int front;          // consumer only
+} TripleBuffer;
+
+void tripleBufferInit(TripleBuffer *buffer);
+
+// The producer's slot. It belongs to the producer until the next publish.
+int tripleBufferBack(const TripleBuffer *buffer);
+void tripleBufferPublish(TripleBuffer *buffer);
+
+// Swaps in the newest published slot. Returns 1 when there was one, 0 when
+// the front slot is already the newest.
+int tripleBufferAcquire(TripleBuffer *buffer);
+int tripleBufferFront(const TripleBuffer *buffer);
+// Whether a slot has been published since the last acquire.
+int tripleBufferPending(TripleBuffer *buffer);
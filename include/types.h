@@ -1,20 +1,28 @@
 #pragma once
 
+#define MAX_DIMENSION 12
+#define MAX_PLANES (MAX_DIMENSION * (MAX_DIMENSION - 1) / 2)
+
 typedef struct { 
     float x, y; 
 } Proj;
 
+// Indexed wireframe: each distinct vertex is stored once in data and edges
+// holds edgeCount pairs of vertex indices into it. data is structure of
+// arrays: axis d of vertex i lives at data[d * stride + i], with stride
+// padded past vertexCount (see vertexStrideFor) and the padding zeroed.
 typedef struct {
+    int  vertexCount;
     int  edgeCount;
     int  dimension;
+    int  stride;
     float *data;
+    int  *edges;
 } EdgeList;
 
+// One angle per rotation plane (a, b) with a < b, in lexicographic order
+// for the current dimension (see planeIndex): 3D is XY, XZ, YZ and 4D is
+// XY, XZ, XW, YZ, YW, ZW.
 typedef struct {
-    float u;
-    float v;
-    float w;
-    float x;
-    float y;
-    float z;
+    float plane[MAX_PLANES];
 } AngleList;
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include <boundedqueue.h>
+
+// Dmitry Vyukov's bounded MPMC ring: every cell carries a sequence number
+// that tells producers and consumers whether it is free for the current
+// lap, so a single CAS on the head or tail claims a cell.
+
+#define CACHE_LINE 64
+
+typedef struct {
+    atomic_size_t sequence;
+    void *item;
+} Cell;
+
+struct BoundedQueue {
+    Cell *cells;
+    size_t mask;
+    char pad0[CACHE_LINE];
+    atomic_size_t tail; // next cell to push
+    char pad1[CACHE_LINE];
+    atomic_size_t head; // next cell to pop
+    char pad2[CACHE_LINE];
+};
+
+BoundedQueue *boundedQueueCreate(int capacity) {
+    size_t size = 2;
+    while (size < (size_t)capacity) size <<= 1;
+
+    BoundedQueue *queue = calloc(1, sizeof(BoundedQueue));
+    if (!queue) return NULL;
+    queue->cells = malloc(size * sizeof(Cell));
+    if (!queue->cells) {
+        free(queue);
+        return NULL;
+    }
+    queue->mask = size - 1;
+    for (size_t i = 0; i < size; i++) atomic_init(&queue->cells[i].sequence, i);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->head, 0);
+    return queue;
+}
+
+void boundedQueueDestroy(BoundedQueue *queue) {
+    if (!queue) return;
+    free(queue->cells);
+    free(queue);
+}
+
+int boundedQueuePush(BoundedQueue *queue, void *item) {
+    size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    for (;;) {
+        Cell *cell = &queue->cells[pos & queue->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                cell->item = item;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0; // a full lap behind: the queue is full
+        } else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+}
+
+int boundedQueuePop(BoundedQueue *queue, void **item) {
+    size_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    for (;;) {
+        Cell *cell = &queue->cells[pos & queue->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *item = cell->item;
+                atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0; // nothing pushed into this cell yet: the queue is empty
+        } else {
+            pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,198 @@
+#include <clip.h>
+
+enum { CLIP_LEFT = 1, CLIP_RIGHT = 2, CLIP_TOP = 4, CLIP_BOTTOM = 8, CLIP_NEAR = 16 };
+
+// Vertices per block when finding which ones sit behind a near plane
+#define CLIP_BLOCK 256
+
+static inline float clampNear(float z) {
+    return z > CAMERA_NEAR ? z : CAMERA_NEAR;
+}
+
+static inline unsigned char outcode(const Camera *cam, Proj p) {
+    return (p.x < -CLIP_MARGIN ? CLIP_LEFT : 0) | (p.x > cam->screenW + CLIP_MARGIN ? CLIP_RIGHT : 0) |
+           (p.y < -CLIP_MARGIN ? CLIP_TOP : 0) | (p.y > cam->screenH + CLIP_MARGIN ? CLIP_BOTTOM : 0);
+}
+
+// Viewport codes come from the projections; the near flag repeats the
+// depth chain of the batch projections, where a vertex behind a plane was
+// only clamped.
+static void vertexCodes(const Camera *cam, int perspective, const EdgeList *mesh, const float *offset,
+                        const Proj *projected, unsigned char *codes) {
+    for (int i = 0; i < mesh->vertexCount; i++) codes[i] = outcode(cam, projected[i]);
+    if (!perspective) return;
+
+    int dim = mesh->dimension, stride = mesh->stride;
+    float hyperF = cam->hyperF, hyperDistance = cam->hyperDistance;
+    float distance = cam->cameraDistance + (offset ? offset[2] : 0.0f);
+    float scale[CLIP_BLOCK];
+    unsigned char near[CLIP_BLOCK];
+
+    for (int base = 0; base < mesh->vertexCount; base += CLIP_BLOCK) {
+        int count = mesh->vertexCount - base;
+        if (count > CLIP_BLOCK) count = CLIP_BLOCK;
+
+        for (int i = 0; i < count; i++) {
+            scale[i] = 1.0f;
+            near[i] = 0;
+        }
+        for (int d = dim - 1; d >= 3; d--) {
+            const float *ws = mesh->data + d * stride + base;
+            for (int i = 0; i < count; i++) {
+                float depth = hyperDistance + ws[i] * scale[i];
+                near[i] |= depth < CAMERA_NEAR;
+                scale[i] *= hyperF / clampNear(depth);
+            }
+        }
+        const float *zs = mesh->data + 2 * stride + base;
+        for (int i = 0; i < count; i++) {
+            near[i] |= zs[i] * scale[i] + distance < CAMERA_NEAR;
+            codes[base + i] |= near[i] ? CLIP_NEAR : 0;
+        }
+    }
+}
+
+// Moves whichever of p, q lies behind the near plane onto it, interpolating
+// their first n coordinates. Returns 0 when both are behind.
+static int clipToNear(float *p, float *q, int n, float *depthP, float *depthQ, int *moved) {
+    float dp = *depthP, dq = *depthQ;
+    if (dp >= CAMERA_NEAR && dq >= CAMERA_NEAR) return 1;
+    if (dp < CAMERA_NEAR && dq < CAMERA_NEAR) return 0;
+
+    if (dp < CAMERA_NEAR) {
+        float t = (CAMERA_NEAR - dp) / (dq - dp);
+        for (int k = 0; k < n; k++) p[k] += t * (q[k] - p[k]);
+        *depthP = CAMERA_NEAR;
+        *moved |= 1;
+    } else {
+        float t = (CAMERA_NEAR - dq) / (dp - dq);
+        for (int k = 0; k < n; k++) q[k] += t * (p[k] - q[k]);
+        *depthQ = CAMERA_NEAR;
+        *moved |= 2;
+    }
+    return 1;
+}
+
+// Carries edge (a, b) down the perspective chain one divide at a time,
+// clipping it at each near plane it crosses on the way, and projects what
+// is left. Returns 0 when no part of it is in front of the camera.
+static int clipSegment(const Camera *cam, const EdgeList *mesh, const float *offset, float fx, float fy,
+                       int a, int b, Proj *pa, Proj *pb, int *moved) {
+    int dim = mesh->dimension, stride = mesh->stride;
+    float p[MAX_DIMENSION], q[MAX_DIMENSION];
+    for (int d = 0; d < dim; d++) {
+        p[d] = mesh->data[d * stride + a];
+        q[d] = mesh->data[d * stride + b];
+    }
+
+    for (int d = dim - 1; d >= 3; d--) {
+        float dp = cam->hyperDistance + p[d], dq = cam->hyperDistance + q[d];
+        if (!clipToNear(p, q, d + 1, &dp, &dq, moved)) return 0;
+        float sp = cam->hyperF / dp, sq = cam->hyperF / dq;
+        for (int k = 0; k < d; k++) {
+            p[k] *= sp;
+            q[k] *= sq;
+        }
+    }
+    if (offset)
+        for (int k = 0; k < 3; k++) {
+            p[k] += offset[k];
+            q[k] += offset[k];
+        }
+
+    float dp = p[2] + cam->cameraDistance, dq = q[2] + cam->cameraDistance;
+    if (!clipToNear(p, q, 3, &dp, &dq, moved)) return 0;
+    *pa = (Proj){ cam->halfW + p[0] * fx / dp, cam->halfH - p[1] * fy / dp };
+    *pb = (Proj){ cam->halfW + q[0] * fx / dq, cam->halfH - q[1] * fy / dq };
+    return 1;
+}
+
+// Cuts segment pq down to the viewport plus CLIP_MARGIN (Liang-Barsky),
+// flagging in moved whichever end it shortened. Returns 0 when the segment
+// misses the viewport.
+static int clipToViewport(const Camera *cam, Proj *p, Proj *q, int *moved) {
+    float dx = q->x - p->x, dy = q->y - p->y;
+    float toward[4] = { -dx, dx, -dy, dy };
+    float room[4] = { p->x + CLIP_MARGIN, cam->screenW + CLIP_MARGIN - p->x,
+                      p->y + CLIP_MARGIN, cam->screenH + CLIP_MARGIN - p->y };
+    float t0 = 0.0f, t1 = 1.0f;
+    for (int k = 0; k < 4; k++) {
+        if (toward[k] == 0.0f) {
+            if (room[k] < 0.0f) return 0;
+            continue;
+        }
+        float t = room[k] / toward[k];
+        if (toward[k] < 0.0f) {
+            if (t > t1) return 0;
+            if (t > t0) t0 = t;
+        } else {
+            if (t < t0) return 0;
+            if (t < t1) t1 = t;
+        }
+    }
+    Proj from = *p;
+    if (t0 > 0.0f) {
+        *p = (Proj){ from.x + t0 * dx, from.y + t0 * dy };
+        *moved |= 1;
+    }
+    if (t1 < 1.0f) {
+        *q = (Proj){ from.x + t1 * dx, from.y + t1 * dy };
+        *moved |= 2;
+    }
+    return 1;
+}
+
+ClipStats clipEdges(const Camera *cam, int perspective, const EdgeList *mesh, const float *offset,
+                    const Proj *projected, int vertexBase, Proj *created, int createdBase, int *out,
+                    unsigned char *codes) {
+    ClipStats stats = {0};
+    if (!codes) {
+        // Without outcodes every edge goes through, as if unclipped
+        for (int e = 0; e < mesh->edgeCount * 2; e++) out[e] = vertexBase + mesh->edges[e];
+        stats.visible = mesh->edgeCount;
+        return stats;
+    }
+    vertexCodes(cam, perspective, mesh, offset, projected, codes);
+
+    // Same x scale as the batch projection this mesh went through
+    float fx = cam->fOverAspect * cam->halfW, fy = cam->f * cam->halfH;
+    if (mesh->dimension > 3 && !offset) fx *= cam->invAspect;
+
+    int createdCount = 0;
+    for (int e = 0; e < mesh->edgeCount; e++) {
+        int a = mesh->edges[e * 2 + 0], b = mesh->edges[e * 2 + 1];
+        unsigned char ca = codes[a], cb = codes[b];
+        int ia = vertexBase + a, ib = vertexBase + b;
+
+        // Viewport codes only hold for vertices in front of every near plane
+        if ((ca & cb) && !((ca | cb) & CLIP_NEAR)) {
+            stats.culled++;
+            continue;
+        }
+        if (ca | cb) {
+            // Partly on screen: cut at the near planes, then to the margin,
+            // so no endpoint leaves the viewport by more than CLIP_MARGIN
+            Proj pa = projected[a], pb = projected[b];
+            int moved = 0;
+            if (((ca | cb) & CLIP_NEAR && !clipSegment(cam, mesh, offset, fx, fy, a, b, &pa, &pb, &moved)) ||
+                !clipToViewport(cam, &pa, &pb, &moved)) {
+                stats.culled++;
+                continue;
+            }
+            if (moved & 1) {
+                created[createdCount] = pa;
+                ia = createdBase + createdCount++;
+            }
+            if (moved & 2) {
+                created[createdCount] = pb;
+                ib = createdBase + createdCount++;
+            }
+            if (moved) stats.clipped++;
+        }
+        out[stats.visible * 2 + 0] = ia;
+        out[stats.visible * 2 + 1] = ib;
+        stats.visible++;
+    }
+
+    return stats;
+}
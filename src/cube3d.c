@@ -0,0 +1,26 @@
+#include <stdlib.h>
+
+#include <cube3d.h>
+#include <math3d.h>
+
+// Generated by tools/cube_tables.c
+extern const EdgeList cubeTables[MAX_DIMENSION + 1];
+
+const EdgeList *cubeMesh(int dimension) {
+    return &cubeTables[dimension >= 3 && dimension <= MAX_DIMENSION ? dimension : 0];
+}
+
+EdgeList createPoseBuffer(const EdgeList *rest) {
+    EdgeList pose = *rest;
+    pose.data = allocVertexData(rest->dimension, rest->stride);
+    return pose;
+}
+
+void freeEdgeList(EdgeList *list) {
+    freeVertexData(list->data);
+    free(list->edges);
+    list->data = NULL;
+    list->edges = NULL;
+    list->vertexCount = 0;
+    list->edgeCount = 0;
+}
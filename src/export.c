@@ -0,0 +1,453 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include <export.h>
+#include <renderer.h>
+#include <boundedqueue.h>
+#include <cube3d.h>
+#include <math3d.h>
+#include <frame.h>
+#include <clip.h>
+#include <polytope.h>
+#include <timer.h>
+#include <trace.h>
+#include <thread.h>
+
+// Raw RGBA files start with this magic followed by little-endian uint32
+// width, height, frame rate numerator, denominator and frame count.
+#define RGBA_MAGIC "CUBERGBA"
+#define RGBA_HEADER_SIZE (8 + 5 * 4)
+
+static const char *formatNames[] = { "y4m", "rgba" };
+
+// One frame in flight. The geometry stage fills projected and the clipped
+// edge list, a raster stage encodes into bytes and the writer streams bytes
+// out before the slot goes back to the free queue.
+typedef struct {
+    int frame;
+    Proj *projected;
+    int *edges;
+    int edgeCount;
+    unsigned char *bytes;
+} FrameSlot;
+
+typedef struct {
+    const ExportOptions *opts;
+    FILE *file;
+    size_t frameBytes;
+
+    FrameSlot *slots;
+    int slotCount;
+    BoundedQueue *freeQueue;   // empty slots, geometry pops
+    BoundedQueue *rasterQueue; // projected frames, raster stages pop
+    BoundedQueue *writeQueue;  // encoded frames in completion order, writer pops
+
+    atomic_int failed;
+    double writeBusy;
+} Exporter;
+
+typedef struct {
+    Exporter *ex;
+    SoftwareRenderer *raster;
+    Thread thread;
+    double busy;
+} RasterStage;
+
+int parseExportArgs(int argc, char **argv, ExportOptions *opts) {
+    int exporting = 0;
+    *opts = (ExportOptions){ NULL, EXPORT_FORMAT_Y4M, 600, 1.0f / 60.0f, 4, 1, 800, 800, 0, 0, NULL, NULL };
+
+    // Every other argument is an export option, wherever --export sits
+    for (int i = 1; i < argc && !exporting; i++) exporting = !strcmp(argv[i], "--export");
+    if (!exporting) return 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "--export")) {
+            if (!value) {
+                fprintf(stderr, "Missing path for --export\n");
+                return -1;
+            }
+            opts->path = value;
+            i++;
+            continue;
+        }
+
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return -1;
+        }
+        if (!strcmp(arg, "--format")) {
+            if (!strcmp(value, "y4m")) opts->format = EXPORT_FORMAT_Y4M;
+            else if (!strcmp(value, "rgba")) opts->format = EXPORT_FORMAT_RGBA;
+            else {
+                fprintf(stderr, "Unknown format %s\n", value);
+                return -1;
+            }
+        }
+        else if (!strcmp(arg, "--frames")) opts->frames = atoi(value);
+        else if (!strcmp(arg, "--dt")) opts->dt = (float)atof(value);
+        else if (!strcmp(arg, "--dimension")) opts->dimension = atoi(value);
+        else if (!strcmp(arg, "--projection")) {
+            if (!strcmp(value, "perspective")) opts->perspective = 1;
+            else if (!strcmp(value, "ortho")) opts->perspective = 0;
+            else {
+                fprintf(stderr, "Unknown projection %s\n", value);
+                return -1;
+            }
+        }
+        else if (!strcmp(arg, "--width")) opts->width = atoi(value);
+        else if (!strcmp(arg, "--height")) opts->height = atoi(value);
+        else if (!strcmp(arg, "--workers")) opts->workers = atoi(value);
+        else if (!strcmp(arg, "--queue-depth")) opts->queueDepth = atoi(value);
+        else if (!strcmp(arg, "--mesh")) opts->mesh = value;
+        else if (!strcmp(arg, "--trace")) opts->trace = value;
+        else {
+            fprintf(stderr, "Unknown export option %s\n", arg);
+            return -1;
+        }
+        i++;
+    }
+
+    if (opts->frames < 1 || opts->dt <= 0.0f || opts->dimension < 3 || opts->dimension > MAX_DIMENSION ||
+        opts->width < 2 || opts->height < 2 || opts->workers < 0 || opts->queueDepth < 0) {
+        fprintf(stderr, "Export options out of range (frames >= 1, dt > 0, dimension 3..%d)\n", MAX_DIMENSION);
+        return -1;
+    }
+    // 4:2:0 chroma covers 2x2 pixel blocks
+    if (opts->format == EXPORT_FORMAT_Y4M && (opts->width % 2 || opts->height % 2)) {
+        fprintf(stderr, "Y4M export needs an even width and height\n");
+        return -1;
+    }
+    return 1;
+}
+
+// Frame rate as a reduced fraction with millihertz precision
+static void frameRate(float dt, unsigned *num, unsigned *den) {
+    unsigned a = (unsigned)lround(1000.0 / dt), b = 1000;
+    unsigned x = a, y = b;
+    while (y) {
+        unsigned t = x % y;
+        x = y;
+        y = t;
+    }
+    *num = a / x;
+    *den = b / x;
+}
+
+static size_t encodedFrameSize(const ExportOptions *opts) {
+    size_t pixels = (size_t)opts->width * opts->height;
+    if (opts->format == EXPORT_FORMAT_RGBA) return pixels * 4;
+    return 6 + pixels + pixels / 2; // "FRAME\n", Y plane, quarter-size U and V planes
+}
+
+static void putU32(unsigned char *out, unsigned v) {
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+    out[2] = (v >> 16) & 0xFF;
+    out[3] = (v >> 24) & 0xFF;
+}
+
+static int writeHeader(const ExportOptions *opts, FILE *file) {
+    unsigned num, den;
+    frameRate(opts->dt, &num, &den);
+    if (opts->format == EXPORT_FORMAT_Y4M)
+        return fprintf(file, "YUV4MPEG2 W%d H%d F%u:%u Ip A1:1 C420jpeg\n", opts->width, opts->height, num, den) > 0;
+
+    unsigned char header[RGBA_HEADER_SIZE];
+    memcpy(header, RGBA_MAGIC, 8);
+    putU32(header + 8, opts->width);
+    putU32(header + 12, opts->height);
+    putU32(header + 16, num);
+    putU32(header + 20, den);
+    putU32(header + 24, opts->frames);
+    return fwrite(header, sizeof(header), 1, file) == 1;
+}
+
+static void encodeRGBA(const Framebuffer *fb, unsigned char *out) {
+    size_t count = (size_t)fb->width * fb->height;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = fb->pixels[i];
+        out[i * 4 + 0] = p & 0xFF;
+        out[i * 4 + 1] = (p >> 8) & 0xFF;
+        out[i * 4 + 2] = (p >> 16) & 0xFF;
+        out[i * 4 + 3] = (p >> 24) & 0xFF;
+    }
+}
+
+// Full-range BT.601 (JFIF) in 8.8 fixed point; chroma from the 2x2 block sum.
+// The +128 chroma bias is folded in before the shift to keep it unsigned;
+// only the top end can overflow.
+static void encodeY4M(const Framebuffer *fb, unsigned char *out) {
+    int w = fb->width, h = fb->height;
+    memcpy(out, "FRAME\n", 6);
+    unsigned char *yPlane = out + 6;
+    unsigned char *uPlane = yPlane + (size_t)w * h;
+    unsigned char *vPlane = uPlane + (size_t)(w / 2) * (h / 2);
+
+    for (int y = 0; y < h; y += 2) {
+        const uint32_t *row0 = fb->pixels + (size_t)y * w;
+        const uint32_t *row1 = row0 + w;
+        unsigned char *y0 = yPlane + (size_t)y * w, *y1 = y0 + w;
+        unsigned char *u = uPlane + (size_t)(y / 2) * (w / 2), *v = vPlane + (size_t)(y / 2) * (w / 2);
+        for (int x = 0; x < w; x += 2) {
+            uint32_t quad[4] = { row0[x], row0[x + 1], row1[x], row1[x + 1] };
+            unsigned char *luma[4] = { y0 + x, y0 + x + 1, y1 + x, y1 + x + 1 };
+            int r = 0, g = 0, b = 0;
+            for (int k = 0; k < 4; k++) {
+                int pr = quad[k] & 0xFF, pg = (quad[k] >> 8) & 0xFF, pb = (quad[k] >> 16) & 0xFF;
+                *luma[k] = (unsigned char)((77 * pr + 150 * pg + 29 * pb + 128) >> 8);
+                r += pr;
+                g += pg;
+                b += pb;
+            }
+            int cb = (-43 * r - 85 * g + 128 * b + 4 * 32896) >> 10;
+            int cr = (128 * r - 107 * g - 21 * b + 4 * 32896) >> 10;
+            u[x / 2] = (unsigned char)(cb > 255 ? 255 : cb);
+            v[x / 2] = (unsigned char)(cr > 255 ? 255 : cr);
+        }
+    }
+}
+
+// Spin briefly, then sleep, so a stage starved by a slower one does not
+// steal its core
+static void backoff(int spins) {
+    if (spins < 64) threadYield();
+    else threadSleepMicros(100);
+}
+
+// Both waits give up and return 0 once another stage has failed
+static int queueWaitPush(Exporter *ex, BoundedQueue *queue, void *item) {
+    for (int spins = 0; !boundedQueuePush(queue, item); spins++) {
+        if (atomic_load(&ex->failed)) return 0;
+        backoff(spins);
+    }
+    return 1;
+}
+
+static int queueWaitPop(Exporter *ex, BoundedQueue *queue, void **item) {
+    for (int spins = 0; !boundedQueuePop(queue, item); spins++) {
+        if (atomic_load(&ex->failed)) return 0;
+        backoff(spins);
+    }
+    return 1;
+}
+
+// A NULL slot tells the stage to stop
+static void rasterStageMain(void *arg) {
+    RasterStage *stage = arg;
+    Exporter *ex = stage->ex;
+    const Framebuffer *fb = softwareRendererFramebuffer(stage->raster);
+    void *item;
+    traceSetThreadName("raster stage");
+
+    while (queueWaitPop(ex, ex->rasterQueue, &item) && item) {
+        FrameSlot *slot = item;
+        double t0 = timerNow();
+        TraceZone zone = traceBegin("raster");
+        softwareRendererDraw(stage->raster, slot->projected, slot->edges, slot->edgeCount,
+                             5.0f, RGBA(200, 200, 200, 255), RGBA(45, 45, 45, 255));
+        traceEnd(&zone);
+        zone = traceBegin("encode");
+        if (ex->opts->format == EXPORT_FORMAT_Y4M) encodeY4M(fb, slot->bytes);
+        else encodeRGBA(fb, slot->bytes);
+        traceEnd(&zone);
+        stage->busy += timerNow() - t0;
+        if (!queueWaitPush(ex, ex->writeQueue, slot)) break;
+    }
+}
+
+// Frames finish out of order across raster stages. At most slotCount frames
+// are in flight and all of them are at or after the next one to write, so
+// frame % slotCount is a collision-free reorder index.
+static void writerStageMain(void *arg) {
+    Exporter *ex = arg;
+    FrameSlot **pending = calloc(ex->slotCount, sizeof(FrameSlot *));
+    if (!pending) {
+        atomic_store(&ex->failed, 1);
+        return;
+    }
+
+    int next = 0;
+    void *item;
+    traceSetThreadName("writer");
+    while (next < ex->opts->frames && queueWaitPop(ex, ex->writeQueue, &item)) {
+        FrameSlot *slot = item;
+        pending[slot->frame % ex->slotCount] = slot;
+
+        while ((slot = pending[next % ex->slotCount]) && slot->frame == next) {
+            double t0 = timerNow();
+            TraceZone zone = traceBegin("write");
+            int ok = fwrite(slot->bytes, 1, ex->frameBytes, ex->file) == ex->frameBytes;
+            traceEnd(&zone);
+            ex->writeBusy += timerNow() - t0;
+            if (!ok) {
+                fprintf(stderr, "Failed writing frame %d\n", next);
+                atomic_store(&ex->failed, 1);
+                break;
+            }
+            pending[next % ex->slotCount] = NULL;
+            next++;
+            queueWaitPush(ex, ex->freeQueue, slot);
+        }
+    }
+    free(pending);
+}
+
+int runExport(const ExportOptions *opts) {
+    int workers = opts->workers > 0 ? opts->workers : hardwareThreadCount() - 2;
+    if (workers < 1) workers = 1;
+    int slotCount = opts->queueDepth > 0 ? opts->queueDepth : workers * 2;
+    if (slotCount < 2) slotCount = 2;
+
+    Polytope poly = {0};
+    if (opts->mesh && !polytopeOpen(&poly, opts->mesh)) return EXIT_FAILURE;
+
+    int toStdout = !strcmp(opts->path, "-");
+#ifdef _WIN32
+    if (toStdout) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    FILE *file = toStdout ? stdout : fopen(opts->path, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", opts->path);
+        polytopeClose(&poly);
+        return EXIT_FAILURE;
+    }
+
+    Exporter ex = {0};
+    ex.opts = opts;
+    EdgeList rest = opts->mesh ? poly.mesh : *cubeMesh(opts->dimension);
+    EdgeList cube = createPoseBuffer(&rest);
+    unsigned char *clipCodes = malloc(rest.vertexCount);
+    ex.file = file;
+    ex.frameBytes = encodedFrameSize(opts);
+    ex.slotCount = slotCount;
+    ex.slots = calloc(slotCount, sizeof(FrameSlot));
+    ex.freeQueue = boundedQueueCreate(slotCount + workers);
+    ex.rasterQueue = boundedQueueCreate(slotCount + workers);
+    ex.writeQueue = boundedQueueCreate(slotCount + workers);
+    RasterStage *stages = calloc(workers, sizeof(RasterStage));
+    atomic_init(&ex.failed, 0);
+
+    int ok = rest.data && cube.data && clipCodes && ex.slots && ex.freeQueue && ex.rasterQueue && ex.writeQueue && stages;
+    for (int s = 0; ok && s < slotCount; s++) {
+        ex.slots[s].projected = malloc((rest.vertexCount + rest.edgeCount * 2) * sizeof(Proj));
+        ex.slots[s].edges = malloc(rest.edgeCount * 2 * sizeof(int));
+        ex.slots[s].bytes = malloc(ex.frameBytes);
+        ok = ex.slots[s].projected && ex.slots[s].edges && ex.slots[s].bytes;
+        if (ok) boundedQueuePush(ex.freeQueue, &ex.slots[s]);
+    }
+    for (int w = 0; ok && w < workers; w++) {
+        stages[w].ex = &ex;
+        stages[w].raster = softwareRendererCreate(opts->width, opts->height, 1);
+        ok = stages[w].raster != NULL;
+    }
+    if (!ok) fprintf(stderr, "Export allocation failed\n");
+    else if (!writeHeader(opts, file)) {
+        fprintf(stderr, "Failed writing header to %s\n", opts->path);
+        ok = 0;
+    }
+
+    int started = 0;
+    Thread writer;
+    int writerStarted = 0;
+    double geometryBusy = 0.0;
+    if (opts->trace) traceSetEnabled(1);
+    traceSetThreadName("geometry");
+    double runStart = timerNow();
+    if (ok) {
+        for (; started < workers; started++)
+            if (threadCreate(&stages[started].thread, rasterStageMain, &stages[started]) != 0) break;
+        writerStarted = threadCreate(&writer, writerStageMain, &ex) == 0;
+        if (!started || !writerStarted) {
+            fprintf(stderr, "Failed to start export threads\n");
+            atomic_store(&ex.failed, 1);
+        }
+
+        // Geometry stage on the calling thread, every plane rotating as in
+        // the headless benchmark
+        int dim = rest.dimension;
+        int rotate[MAX_PLANES];
+        for (int p = 0; p < MAX_PLANES; p++) rotate[p] = 1;
+        Orientation orientation;
+        orientationReset(&orientation, dim);
+        float radianPerSecond = 50.0f * (M_PI/180.0f);
+        float matrix[MAX_DIMENSION * MAX_DIMENSION];
+        Camera camera;
+        cameraUpdate(&camera, opts->width, opts->height, 0.5f, 1.5f, 90.0f, 1.5f, 90.0f);
+
+        void *item;
+        for (int f = 0; f < opts->frames && queueWaitPop(&ex, ex.freeQueue, &item); f++) {
+            FrameSlot *slot = item;
+            double t0 = timerNow();
+            TraceZone zone = traceBegin("geometry");
+            orientationMatrix(&orientation, matrix);
+            frameAdvance(&orientation, rotate, opts->dt, radianPerSecond);
+            transformVerticesN(matrix, &rest, &cube);
+            frameProject(&camera, opts->perspective, &cube, slot->projected);
+            slot->edgeCount = clipEdges(&camera, opts->perspective, &cube, NULL, slot->projected, 0,
+                                        slot->projected + rest.vertexCount, rest.vertexCount, slot->edges,
+                                        clipCodes).visible;
+            slot->frame = f;
+            traceEnd(&zone);
+            geometryBusy += timerNow() - t0;
+            if (!queueWaitPush(&ex, ex.rasterQueue, slot)) break;
+        }
+        for (int w = 0; w < started; w++)
+            if (!queueWaitPush(&ex, ex.rasterQueue, NULL)) break;
+    }
+
+    for (int w = 0; w < started; w++) threadJoin(stages[w].thread);
+    if (writerStarted) threadJoin(writer);
+    if (fflush(file) != 0) atomic_store(&ex.failed, 1);
+    if (opts->trace && !traceWriteChrome(opts->trace)) fprintf(stderr, "Failed to write %s\n", opts->trace);
+    double elapsed = timerNow() - runStart;
+
+    ok = ok && !atomic_load(&ex.failed);
+    if (ok) {
+        // Summary goes to stderr so the video can be piped from stdout
+        double rasterBusy = 0.0;
+        for (int w = 0; w < workers; w++) rasterBusy += stages[w].busy;
+        size_t bufferBytes = (size_t)slotCount * (ex.frameBytes + (rest.vertexCount + rest.edgeCount * 2) * sizeof(Proj) +
+                                                rest.edgeCount * 2 * sizeof(int)) +
+                             (size_t)workers * opts->width * opts->height * sizeof(uint32_t);
+        fprintf(stderr, "{\n");
+        fprintf(stderr, "  \"path\": \"%s\",\n  \"format\": \"%s\",\n  \"frames\": %d,\n  \"width\": %d,\n  \"height\": %d,\n  \"dimension\": %d,\n",
+                opts->path, formatNames[opts->format], opts->frames, opts->width, opts->height, rest.dimension);
+        fprintf(stderr, "  \"raster_workers\": %d,\n  \"queue_depth\": %d,\n  \"frame_bytes\": %zu,\n  \"buffer_bytes\": %zu,\n",
+                workers, slotCount, ex.frameBytes, bufferBytes);
+        fprintf(stderr, "  \"seconds\": %.3f,\n  \"frames_per_second\": %.1f,\n  \"megabytes_per_second\": %.1f,\n",
+                elapsed, opts->frames / elapsed, opts->frames * (double)ex.frameBytes / elapsed / 1e6);
+        fprintf(stderr, "  \"stage_utilization\": { \"geometry\": %.3f, \"raster\": %.3f, \"write\": %.3f }\n}\n",
+                geometryBusy / elapsed, rasterBusy / (elapsed * workers), ex.writeBusy / elapsed);
+    }
+
+    for (int w = 0; stages && w < workers; w++) softwareRendererDestroy(stages[w].raster);
+    for (int s = 0; ex.slots && s < slotCount; s++) {
+        free(ex.slots[s].projected);
+        free(ex.slots[s].edges);
+        free(ex.slots[s].bytes);
+    }
+    free(stages);
+    free(ex.slots);
+    boundedQueueDestroy(ex.freeQueue);
+    boundedQueueDestroy(ex.rasterQueue);
+    boundedQueueDestroy(ex.writeQueue);
+    polytopeClose(&poly);
+    freeVertexData(cube.data);
+    free(clipCodes);
+    if (!toStdout && fclose(file) != 0) ok = 0;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,21 @@
+#include <frame.h>
+#include <math3d.h>
+
+void frameComposeRotation(const AngleList *angles, int dim, float *matrix) {
+    if (dim == 3) composeRotation3D(angles, matrix);
+    else composeRotationN(angles, matrix, dim);
+}
+
+void frameAdvance(Orientation *orientation, const int *rotate, float dt, float radiansPerSecond) {
+    AngleList delta = {0};
+    for (int p = 0; p < planeCount(orientation->dimension); p++)
+        if (rotate[p]) delta.plane[p] = dt * radiansPerSecond;
+    orientationAdvance(orientation, &delta);
+}
+
+void frameProject(const Camera *cam, int perspective, const EdgeList *verts, Proj *out) {
+    // Ortho only reads x and y, so the N-D flatten step can be skipped.
+    if (perspective && verts->dimension == 3) projectPerspectiveBatch(cam, verts, out);
+    else if (perspective) projectHyperBatch(cam, verts, out);
+    else projectOrthoBatch(cam, verts, out);
+}
@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glad/glad.h>
+
+#include <renderer.h>
+
+// Positions stream through an orphaned vertex buffer as window-space
+// points, scaled to framebuffer pixels in the vertex shader. Edges are
+// GL_LINES element pairs, and the geometry shader turns each line into a
+// quad around its capsule. The fragment shader measures the distance to
+// the segment, which gives the same round caps and half-pixel AA ramp as
+// the CPU rasterizer.
+static const char *vertexSource =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 position;\n"
+    "uniform float pixelScale;\n"
+    "void main() { gl_Position = vec4(position * pixelScale, 0.0, 1.0); }\n";
+
+static const char *geometrySource =
+    "#version 330 core\n"
+    "layout(lines) in;\n"
+    "layout(triangle_strip, max_vertices = 4) out;\n"
+    "uniform vec2 viewport;\n"
+    "uniform float extent;\n"
+    "noperspective out vec2 local;\n"
+    "flat out float segmentLength;\n"
+    "void corner(vec2 p, vec2 l) {\n"
+    "    local = l;\n"
+    "    gl_Position = vec4(p.x / viewport.x * 2.0 - 1.0, 1.0 - p.y / viewport.y * 2.0, 0.0, 1.0);\n"
+    "    EmitVertex();\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 a = gl_in[0].gl_Position.xy, b = gl_in[1].gl_Position.xy;\n"
+    "    if (any(isnan(vec4(a, b))) || any(isinf(vec4(a, b)))) return;\n"
+    "    float len = length(b - a);\n"
+    "    vec2 dir = len > 1e-6 ? (b - a) / len : vec2(1.0, 0.0);\n"
+    "    vec2 side = vec2(-dir.y, dir.x) * extent;\n"
+    "    vec2 back = dir * extent;\n"
+    "    segmentLength = len;\n"
+    "    corner(a - back - side, vec2(-extent, -extent));\n"
+    "    corner(a - back + side, vec2(-extent, extent));\n"
+    "    corner(b + back - side, vec2(len + extent, -extent));\n"
+    "    corner(b + back + side, vec2(len + extent, extent));\n"
+    "    EndPrimitive();\n"
+    "}\n";
+
+static const char *fragmentSource =
+    "#version 330 core\n"
+    "uniform vec4 color;\n"
+    "uniform float halfThickness;\n"
+    "noperspective in vec2 local;\n"
+    "flat in float segmentLength;\n"
+    "out vec4 fragment;\n"
+    "void main() {\n"
+    "    float along = local.x - clamp(local.x, 0.0, segmentLength);\n"
+    "    float coverage = clamp(halfThickness + 0.5 - length(vec2(along, local.y)), 0.0, 1.0);\n"
+    "    if (coverage <= 0.0) discard;\n"
+    "    fragment = vec4(color.rgb, color.a * coverage);\n"
+    "}\n";
+
+struct LineRenderer {
+    GLuint program;
+    GLint pixelScaleLoc, viewportLoc, extentLoc, colorLoc, halfThicknessLoc;
+    GLuint vao;
+    GLuint positions;     // streamed every draw
+    GLsizeiptr positionCapacity;
+    GLuint edges;         // uploaded once per topology
+    int edgeCount;
+    unsigned edgeKey;
+    int hasEdges;
+    GLuint streamedEdges; // frames whose edge list differs from the topology
+    GLsizeiptr streamedCapacity;
+
+    GLuint framebuffer, colorbuffer;
+    int targetWidth, targetHeight;
+};
+
+static GLuint compileShader(GLenum type, const char *source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Line shader failed to compile: %s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint linkProgram(void) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint gs = compileShader(GL_GEOMETRY_SHADER, geometrySource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    GLuint program = 0;
+    if (vs && gs && fs) {
+        program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, gs);
+        glAttachShader(program, fs);
+        glLinkProgram(program);
+        GLint ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(program, sizeof(log), NULL, log);
+            fprintf(stderr, "Line shader failed to link: %s\n", log);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    glDeleteShader(vs);
+    glDeleteShader(gs);
+    glDeleteShader(fs);
+    return program;
+}
+
+LineRenderer *lineRendererCreate(void) {
+    LineRenderer *r = calloc(1, sizeof(LineRenderer));
+    if (!r) return NULL;
+    r->program = linkProgram();
+    if (!r->program) {
+        free(r);
+        return NULL;
+    }
+    r->pixelScaleLoc = glGetUniformLocation(r->program, "pixelScale");
+    r->viewportLoc = glGetUniformLocation(r->program, "viewport");
+    r->extentLoc = glGetUniformLocation(r->program, "extent");
+    r->colorLoc = glGetUniformLocation(r->program, "color");
+    r->halfThicknessLoc = glGetUniformLocation(r->program, "halfThickness");
+
+    glGenVertexArrays(1, &r->vao);
+    glGenBuffers(1, &r->positions);
+    glGenBuffers(1, &r->edges);
+    glGenBuffers(1, &r->streamedEdges);
+    glBindVertexArray(r->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, r->positions);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Proj), NULL);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return r;
+}
+
+void lineRendererDestroy(LineRenderer *r) {
+    if (!r) return;
+    glDeleteProgram(r->program);
+    glDeleteVertexArrays(1, &r->vao);
+    glDeleteBuffers(1, &r->positions);
+    glDeleteBuffers(1, &r->edges);
+    glDeleteBuffers(1, &r->streamedEdges);
+    if (r->framebuffer) glDeleteFramebuffers(1, &r->framebuffer);
+    if (r->colorbuffer) glDeleteRenderbuffers(1, &r->colorbuffer);
+    free(r);
+}
+
+// Orphans buffer and refills it, so the driver hands out fresh storage
+// instead of waiting for draws still reading the old contents
+static void streamBuffer(GLenum target, GLsizeiptr *capacity, const void *data, GLsizeiptr bytes) {
+    if (bytes > *capacity) {
+        GLsizeiptr grown = *capacity ? *capacity : 4096;
+        while (grown < bytes) grown *= 2;
+        *capacity = grown;
+    }
+    glBufferData(target, *capacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, bytes, data);
+}
+
+size_t lineRendererDraw(LineRenderer *r, const Proj *verts, int vertexCount, const int *edges, int edgeCount,
+                        int complete, unsigned key, float width, float height, float pixelScale, float thickness,
+                        uint32_t color) {
+    if (edgeCount <= 0 || vertexCount <= 0) return 0;
+    size_t uploaded = 0;
+    glBindVertexArray(r->vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, r->positions);
+    streamBuffer(GL_ARRAY_BUFFER, &r->positionCapacity, verts, (GLsizeiptr)vertexCount * sizeof(Proj));
+    uploaded += (size_t)vertexCount * sizeof(Proj);
+
+    GLsizeiptr edgeBytes = (GLsizeiptr)edgeCount * 2 * sizeof(int);
+    if (complete) {
+        // The whole topology: kept on the GPU for as long as key holds
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r->edges);
+        if (!r->hasEdges || r->edgeKey != key || r->edgeCount != edgeCount) {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, edgeBytes, edges, GL_STATIC_DRAW);
+            r->hasEdges = 1;
+            r->edgeKey = key;
+            r->edgeCount = edgeCount;
+            uploaded += (size_t)edgeBytes;
+        }
+    } else {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r->streamedEdges);
+        streamBuffer(GL_ELEMENT_ARRAY_BUFFER, &r->streamedCapacity, edges, edgeBytes);
+        uploaded += (size_t)edgeBytes;
+    }
+
+    float halfThickness = thickness * pixelScale * 0.5f;
+    glUseProgram(r->program);
+    glUniform1f(r->pixelScaleLoc, pixelScale);
+    glUniform2f(r->viewportLoc, width, height);
+    glUniform1f(r->extentLoc, halfThickness + 1.0f);
+    glUniform1f(r->halfThicknessLoc, halfThickness);
+    glUniform4f(r->colorLoc, (color & 0xff) / 255.0f, ((color >> 8) & 0xff) / 255.0f,
+                ((color >> 16) & 0xff) / 255.0f, (color >> 24) / 255.0f);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_SCISSOR_TEST);
+    glDrawElements(GL_LINES, edgeCount * 2, GL_UNSIGNED_INT, NULL);
+
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisable(GL_BLEND);
+    return uploaded;
+}
+
+void lineRendererClear(LineRenderer *r, uint32_t background) {
+    (void)r;
+    glClearColor((background & 0xff) / 255.0f, ((background >> 8) & 0xff) / 255.0f,
+                 ((background >> 16) & 0xff) / 255.0f, (background >> 24) / 255.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+int lineRendererOffscreen(LineRenderer *r, int width, int height) {
+    if (!r->framebuffer) {
+        glGenFramebuffers(1, &r->framebuffer);
+        glGenRenderbuffers(1, &r->colorbuffer);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, r->colorbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, r->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, r->colorbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return 0;
+    }
+    glViewport(0, 0, width, height);
+    r->targetWidth = width;
+    r->targetHeight = height;
+    return 1;
+}
+
+int lineRendererReadPixels(LineRenderer *r, Framebuffer *fb) {
+    if (!r->framebuffer || fb->width != r->targetWidth || fb->height != r->targetHeight) return 0;
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, fb->width, fb->height, GL_RGBA, GL_UNSIGNED_BYTE, fb->pixels);
+    // GL rows run bottom-up
+    for (int y = 0; y < fb->height / 2; y++) {
+        uint32_t *top = fb->pixels + (size_t)y * fb->width;
+        uint32_t *bottom = fb->pixels + (size_t)(fb->height - 1 - y) * fb->width;
+        for (int x = 0; x < fb->width; x++) {
+            uint32_t t = top[x];
+            top[x] = bottom[x];
+            bottom[x] = t;
+        }
+    }
+    return glGetError() == GL_NO_ERROR;
+}
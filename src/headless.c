@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <nk_config.h>
+#include <nuklear.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <headless.h>
+#include <renderer.h>
+#include <instances.h>
+#include <cube3d.h>
+#include <math3d.h>
+#include <frame.h>
+#include <clip.h>
+#include <polytope.h>
+#include <slice.h>
+#include <lod.h>
+#include <timer.h>
+#include <trace.h>
+#include <thread.h>
+
+enum { STAGE_COMPOSE, STAGE_TRANSFORM, STAGE_PROJECT, STAGE_EMIT, STAGE_FRAME, STAGE_COUNT };
+static const char *stageNames[STAGE_COUNT] = { "compose", "transform", "project", "emit", "frame" };
+static const char *sinkNames[] = { "null", "nuklear", "raster", "gl" };
+
+int parseHeadlessArgs(int argc, char **argv, HeadlessOptions *opts) {
+    int headless = 0;
+    *opts = (HeadlessOptions){ 1000, 1.0f / 60.0f, 4, 1, HEADLESS_SINK_NULL, 0, 0, 1.5f, NULL, 800, 800, NULL, NULL, NULL, 0, 0.0f, 0.0f };
+
+    // Every other argument is a headless option, wherever --headless sits
+    for (int i = 1; i < argc && !headless; i++) headless = !strcmp(argv[i], "--headless");
+    if (!headless) return 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "--headless")) continue;
+
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return -1;
+        }
+        if (!strcmp(arg, "--frames")) opts->frames = atoi(value);
+        else if (!strcmp(arg, "--dt")) opts->dt = (float)atof(value);
+        else if (!strcmp(arg, "--dimension")) opts->dimension = atoi(value);
+        else if (!strcmp(arg, "--projection")) {
+            if (!strcmp(value, "perspective")) opts->perspective = 1;
+            else if (!strcmp(value, "ortho")) opts->perspective = 0;
+            else {
+                fprintf(stderr, "Unknown projection %s\n", value);
+                return -1;
+            }
+        }
+        else if (!strcmp(arg, "--sink")) {
+            if (!strcmp(value, "null")) opts->sink = HEADLESS_SINK_NULL;
+            else if (!strcmp(value, "nuklear")) opts->sink = HEADLESS_SINK_NUKLEAR;
+            else if (!strcmp(value, "raster")) opts->sink = HEADLESS_SINK_RASTER;
+            else if (!strcmp(value, "gl")) opts->sink = HEADLESS_SINK_GL;
+            else {
+                fprintf(stderr, "Unknown sink %s\n", value);
+                return -1;
+            }
+        }
+        else if (!strcmp(arg, "--threads")) opts->threads = atoi(value);
+        else if (!strcmp(arg, "--instances")) opts->instances = atoi(value);
+        else if (!strcmp(arg, "--camera-distance")) opts->cameraDistance = (float)atof(value);
+        else if (!strcmp(arg, "--mesh")) opts->mesh = value;
+        else if (!strcmp(arg, "--frame-output")) opts->frameOutput = value;
+        else if (!strcmp(arg, "--trace")) opts->trace = value;
+        else if (!strcmp(arg, "--lod")) opts->lodCell = (float)atof(value);
+        else if (!strcmp(arg, "--slice")) {
+            opts->slice = 1;
+            opts->sliceOffset = (float)atof(value);
+        }
+        else if (!strcmp(arg, "--width")) opts->width = atoi(value);
+        else if (!strcmp(arg, "--height")) opts->height = atoi(value);
+        else if (!strcmp(arg, "--output")) opts->output = value;
+        else {
+            fprintf(stderr, "Unknown headless option %s\n", arg);
+            return -1;
+        }
+        i++;
+    }
+
+    if (opts->frames < 1 || opts->dimension < 3 || opts->dimension > MAX_DIMENSION || opts->width < 1 || opts->height < 1 || opts->instances < 0) {
+        fprintf(stderr, "Headless options out of range (frames >= 1, dimension 3..%d, instances >= 0)\n", MAX_DIMENSION);
+        return -1;
+    }
+    if (opts->slice && opts->instances) {
+        fprintf(stderr, "--slice cuts the single mesh and cannot be combined with --instances\n");
+        return -1;
+    }
+    return 1;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void writeStage(FILE *out, const char *name, double *samples, int count, int last) {
+    qsort(samples, count, sizeof(double), compareDouble);
+    int p99 = (int)ceil(count * 0.99) - 1;
+    fprintf(out, "    \"%s\": { \"min_us\": %.3f, \"median_us\": %.3f, \"p99_us\": %.3f }%s\n",
+            name, samples[0] * 1e6, samples[count / 2] * 1e6, samples[p99] * 1e6, last ? "" : ",");
+}
+
+// GL 3.3 core context for the gl sink behind a hidden window: the native
+// platform when there is a display, otherwise (GLFW 3.4+) the null platform
+// with an OSMesa context, which runs on Mesa's llvmpipe anywhere
+static GLFWwindow *openOffscreenContext(void) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (attempt == 1) {
+#ifdef GLFW_PLATFORM_NULL
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+            break;
+#endif
+        }
+        if (!glfwInit()) continue;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        #ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+        #endif
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef GLFW_OSMESA_CONTEXT_API
+        if (attempt == 1) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+        GLFWwindow *win = glfwCreateWindow(64, 64, "cube-demo headless", NULL, NULL);
+        if (win) {
+            glfwMakeContextCurrent(win);
+            if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) return win;
+            glfwDestroyWindow(win);
+        }
+        glfwTerminate();
+    }
+    return NULL;
+}
+
+int runHeadless(const HeadlessOptions *opts) {
+    int frames = opts->frames;
+    Polytope poly = {0};
+    if (opts->mesh && !polytopeOpen(&poly, opts->mesh)) return EXIT_FAILURE;
+    EdgeList rest = opts->mesh ? poly.mesh : *cubeMesh(opts->dimension);
+    EdgeList cube = createPoseBuffer(&rest);
+    int dim = rest.dimension;
+    // A cross-section is cut from the transformed mesh every frame and
+    // projected in its place: one vertex per mesh edge and at most one edge
+    // per square face
+    Slicer slicer = {0};
+    if (opts->slice && !slicerCreate(&slicer, &rest)) {
+        fprintf(stderr, "--slice needs an n-cube of dimension 4 or more\n");
+        polytopeClose(&poly);
+        freeVertexData(cube.data);
+        return EXIT_FAILURE;
+    }
+    int meshVertices = opts->slice ? slicer.slice.vertexCount : rest.vertexCount;
+    int meshEdges = opts->slice ? slicer.faceCount : rest.edgeCount;
+    Proj *projected = malloc((meshVertices + meshEdges * 2) * sizeof(Proj));
+    int *visibleEdges = malloc(meshEdges * 2 * sizeof(int));
+    unsigned char *clipCodes = malloc(meshVertices);
+    double *samples = malloc((size_t)frames * STAGE_COUNT * sizeof(double));
+    SoftwareRenderer *raster = NULL;
+    if (opts->sink == HEADLESS_SINK_RASTER) raster = softwareRendererCreate(opts->width, opts->height, opts->threads);
+    GLFWwindow *glWindow = NULL;
+    LineRenderer *lines = NULL;
+    if (opts->sink == HEADLESS_SINK_GL) {
+        glWindow = openOffscreenContext();
+        if (glWindow) lines = lineRendererCreate();
+        if (lines && !lineRendererOffscreen(lines, opts->width, opts->height)) {
+            lineRendererDestroy(lines);
+            lines = NULL;
+        }
+        if (!lines) {
+            fprintf(stderr, "No GL 3.3 context for the gl sink\n");
+            if (glWindow) {
+                glfwDestroyWindow(glWindow);
+                glfwTerminate();
+            }
+            slicerFree(&slicer);
+            polytopeClose(&poly);
+            freeVertexData(cube.data);
+            free(projected);
+            free(visibleEdges);
+            free(clipCodes);
+            free(samples);
+            return EXIT_FAILURE;
+        }
+    }
+    InstanceSet scene = {0};
+    ThreadPool *pool = NULL;
+    if (opts->instances) {
+        pool = threadPoolCreate(opts->threads);
+        if (!instanceSetCreate(&scene, opts->instances, 3, dim, 1)) scene.count = -1;
+    }
+    if (!rest.data || !cube.data || !projected || !visibleEdges || !clipCodes || !samples || (opts->sink == HEADLESS_SINK_RASTER && !raster) ||
+        (opts->instances && (!pool || scene.count < 0))) {
+        fprintf(stderr, "Headless allocation failed\n");
+        softwareRendererDestroy(raster);
+        lineRendererDestroy(lines);
+        if (glWindow) {
+            glfwDestroyWindow(glWindow);
+            glfwTerminate();
+        }
+        threadPoolDestroy(pool);
+        instanceSetFree(&scene);
+        slicerFree(&slicer);
+        polytopeClose(&poly);
+        freeVertexData(cube.data);
+        free(projected);
+        free(visibleEdges);
+        free(clipCodes);
+        free(samples);
+        return EXIT_FAILURE;
+    }
+
+    // Every plane rotates so compose does its full amount of work
+    int rotate[MAX_PLANES];
+    for (int p = 0; p < MAX_PLANES; p++) rotate[p] = 1;
+    Orientation orientation;
+    orientationReset(&orientation, dim);
+    float radianPerSecond = 50.0f * (M_PI/180.0f);
+    float matrix[MAX_DIMENSION * MAX_DIMENSION];
+    Camera camera;
+
+    struct nk_buffer buffer;
+    struct nk_command_buffer canvas;
+    nk_buffer_init_default(&buffer);
+    memset(&canvas, 0, sizeof(canvas));
+    canvas.base = &buffer;
+    canvas.use_clipping = NK_CLIPPING_OFF;
+    double checksum = 0.0;
+    double uploadedBytes = 0.0;
+
+    // What the emit stage draws: the single cube or the whole instance
+    // batch, minus whatever clipping removed
+    const Proj *verts = opts->instances ? scene.projected : projected;
+    const int *edges = opts->instances ? scene.edges : visibleEdges;
+    int vertexCount = opts->instances ? scene.vertexCount : meshVertices;
+    int totalEdges = opts->instances ? scene.totalEdgeCount : meshEdges;
+    ClipStats clip = {0};
+    EdgeLod edgeLod = {0};
+    LodStats lod = {0};
+
+    if (opts->trace) traceSetEnabled(1);
+    traceSetThreadName("main");
+    double runStart = timerNow();
+    for (int f = 0; f < frames; f++) {
+        double *t = samples + (size_t)f * STAGE_COUNT;
+        TraceZone frame = traceBegin("frame");
+        double t0 = timerNow();
+        TraceZone zone = traceBegin("compose");
+
+        // Instances compose their own rotations inside the transform stage
+        if (!opts->instances) {
+            orientationMatrix(&orientation, matrix);
+            frameAdvance(&orientation, rotate, opts->dt, radianPerSecond);
+        }
+        traceEnd(&zone);
+        double t1 = timerNow();
+
+        zone = traceBegin("transform");
+        if (opts->instances) instanceSetTransform(&scene, pool, opts->dt);
+        else transformVerticesN(matrix, &rest, &cube);
+        traceEnd(&zone);
+        double t2 = timerNow();
+
+        zone = traceBegin("project");
+        cameraUpdate(&camera, opts->width, opts->height, 0.5f, opts->cameraDistance, 90.0f, 1.5f, 90.0f);
+        if (opts->instances) {
+            instanceSetProject(&scene, pool, &camera, opts->perspective);
+            clip = (ClipStats){ scene.edgeCount, scene.clippedEdges, scene.culledEdges };
+        } else {
+            const EdgeList *shown = &cube;
+            if (opts->slice) {
+                TraceZone cut = traceBegin("slice");
+                slicerCut(&slicer, &cube, opts->sliceOffset);
+                traceEnd(&cut);
+                shown = &slicer.slice;
+            }
+            frameProject(&camera, opts->perspective, shown, projected);
+            clip = clipEdges(&camera, opts->perspective, shown, NULL, projected, 0, projected + meshVertices,
+                             meshVertices, visibleEdges, clipCodes);
+        }
+        int edgeCount = clip.visible;
+        if (opts->lodCell > 0.0f) {
+            TraceZone reduce = traceBegin("lod");
+            int *visible = opts->instances ? scene.edges : visibleEdges;
+            lod = edgeLodReduce(&edgeLod, verts, vertexCount, visible, clip.visible, opts->lodCell, visible);
+            edgeCount = lod.drawn;
+            traceEnd(&reduce);
+        }
+        traceEnd(&zone);
+        double t3 = timerNow();
+
+        zone = traceBegin("emit");
+        if (opts->sink == HEADLESS_SINK_RASTER) {
+            checksum += softwareRendererDraw(raster, verts, edges, edgeCount, opts->instances ? 1.5f : 5.0f, RGBA(200, 200, 200, 255), RGBA(45, 45, 45, 255));
+        } else if (opts->sink == HEADLESS_SINK_GL) {
+            // Endpoints made by clipping sit after the vertices. glFinish
+            // makes the stage time the GPU work rather than its submission.
+            int streamed = vertexCount + (clip.clipped ? 2 * totalEdges : 0);
+            lineRendererClear(lines, RGBA(45, 45, 45, 255));
+            size_t uploaded = lineRendererDraw(lines, verts, streamed, edges, edgeCount,
+                                               !clip.clipped && !clip.culled && !opts->slice && !lod.merged && !lod.degenerate, 1,
+                                               (float)opts->width, (float)opts->height, 1.0f, opts->instances ? 1.5f : 5.0f,
+                                               RGBA(200, 200, 200, 255));
+            glFinish();
+            uploadedBytes += (double)uploaded;
+            checksum += (double)uploaded;
+        } else if (opts->sink == HEADLESS_SINK_NUKLEAR) {
+            nk_buffer_clear(&buffer);
+            canvas.begin = canvas.end = canvas.last = 0;
+            for (int i = 0; i < edgeCount; i++) {
+                Proj zero = verts[edges[i * 2 + 0]];
+                Proj one  = verts[edges[i * 2 + 1]];
+                nk_stroke_line(&canvas, zero.x, zero.y, one.x, one.y, 5.0f, nk_rgb(200, 200, 200));
+            }
+            checksum += (double)buffer.allocated;
+        } else {
+            // Null sink: fold the endpoints so the emission loop is not elided
+            float sum = 0.0f;
+            for (int i = 0; i < edgeCount; i++) {
+                Proj zero = verts[edges[i * 2 + 0]];
+                Proj one  = verts[edges[i * 2 + 1]];
+                sum += zero.x + zero.y + one.x + one.y;
+            }
+            checksum += sum;
+        }
+        traceEnd(&zone);
+        double t4 = timerNow();
+        traceEnd(&frame);
+
+        t[STAGE_COMPOSE] = t1 - t0;
+        t[STAGE_TRANSFORM] = t2 - t1;
+        t[STAGE_PROJECT] = t3 - t2;
+        t[STAGE_EMIT] = t4 - t3;
+        t[STAGE_FRAME] = t4 - t0;
+    }
+    double elapsed = timerNow() - runStart;
+
+    int status = EXIT_SUCCESS;
+    FILE *out = opts->output ? fopen(opts->output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Failed to open %s\n", opts->output);
+        status = EXIT_FAILURE;
+    } else {
+        fprintf(out, "{\n");
+        if (opts->mesh) fprintf(out, "  \"mesh\": \"%.16s\",\n", poly.header->name);
+        fprintf(out, "  \"dimension\": %d,\n  \"projection\": \"%s\",\n  \"sink\": \"%s\",\n",
+                dim, opts->perspective ? "perspective" : "ortho", sinkNames[opts->sink]);
+        if (raster) fprintf(out, "  \"raster_threads\": %d,\n", opts->threads > 0 ? opts->threads : hardwareThreadCount());
+        if (lines) fprintf(out, "  \"gl_renderer\": \"%s\",\n  \"gl_upload_bytes_per_frame\": %.1f,\n",
+                           (const char *)glGetString(GL_RENDERER), uploadedBytes / frames);
+        if (opts->slice) fprintf(out, "  \"slice_offset\": %g,\n  \"slice_edges\": %d,\n", opts->sliceOffset, slicer.slice.edgeCount);
+        if (opts->lodCell > 0.0f)
+            fprintf(out, "  \"lod\": { \"cell\": %g, \"submitted\": %d, \"drawn\": %d, \"merged\": %d, \"degenerate\": %d },\n",
+                    opts->lodCell, lod.submitted, lod.drawn, lod.merged, lod.degenerate);
+        if (pool) fprintf(out, "  \"instances\": %d,\n  \"instance_threads\": %d,\n", scene.count, threadPoolSize(pool));
+        fprintf(out, "  \"frames\": %d,\n  \"dt\": %g,\n  \"vertices\": %d,\n  \"edges\": %d,\n  \"transform_backend\": \"%s\",\n",
+                frames, opts->dt, vertexCount, totalEdges, transformBackendName());
+        fprintf(out, "  \"camera_distance\": %g,\n  \"last_frame_edges\": { \"visible\": %d, \"clipped\": %d, \"culled\": %d },\n",
+                opts->cameraDistance, clip.visible, clip.clipped, clip.culled);
+        fprintf(out, "  \"stages\": {\n");
+
+        // Gather each stage's samples contiguously before sorting
+        double *column = malloc(frames * sizeof(double));
+        for (int s = 0; s < STAGE_COUNT && column; s++) {
+            for (int f = 0; f < frames; f++) column[f] = samples[(size_t)f * STAGE_COUNT + s];
+            writeStage(out, stageNames[s], column, frames, s == STAGE_COUNT - 1);
+        }
+        free(column);
+
+        fprintf(out, "  },\n  \"throughput\": {\n");
+        fprintf(out, "    \"frames_per_second\": %.1f,\n    \"instances_per_second\": %.0f,\n    \"vertices_per_second\": %.0f,\n    \"edges_per_second\": %.0f\n",
+                frames / elapsed, (double)frames * (opts->instances ? scene.count : 1) / elapsed,
+                (double)frames * vertexCount / elapsed, (double)frames * totalEdges / elapsed);
+        fprintf(out, "  },\n  \"checksum\": %g\n}\n", checksum);
+        if (out != stdout) fclose(out);
+    }
+
+    if (opts->trace && !traceWriteChrome(opts->trace)) fprintf(stderr, "Failed to write %s\n", opts->trace);
+    if (raster && opts->frameOutput && !framebufferWritePPM(softwareRendererFramebuffer(raster), opts->frameOutput))
+        fprintf(stderr, "Failed to write %s\n", opts->frameOutput);
+    if (lines && opts->frameOutput) {
+        Framebuffer fb = { opts->width, opts->height, malloc((size_t)opts->width * opts->height * sizeof(uint32_t)) };
+        if (!fb.pixels || !lineRendererReadPixels(lines, &fb) || !framebufferWritePPM(&fb, opts->frameOutput))
+            fprintf(stderr, "Failed to write %s\n", opts->frameOutput);
+        free(fb.pixels);
+    }
+
+    softwareRendererDestroy(raster);
+    lineRendererDestroy(lines);
+    if (glWindow) {
+        glfwDestroyWindow(glWindow);
+        glfwTerminate();
+    }
+    threadPoolDestroy(pool);
+    instanceSetFree(&scene);
+    nk_buffer_free(&buffer);
+    edgeLodFree(&edgeLod);
+    slicerFree(&slicer);
+    polytopeClose(&poly);
+    freeVertexData(cube.data);
+    free(projected);
+    free(visibleEdges);
+    free(clipCodes);
+    free(samples);
+    return status;
+}
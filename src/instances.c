@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include <instances.h>
+#include <cube3d.h>
+#include <math3d.h>
+#include <frame.h>
+
+// Instances per stolen chunk; small enough to rebalance mixed dimensions
+#define INSTANCE_GRAIN 16
+
+typedef struct {
+    InstanceSet *set;
+    float dt;
+    const Camera *cam;
+    int perspective;
+} InstanceJob;
+
+// xorshift32, so scenes are identical across platforms for a given seed
+static float randomUnit(unsigned *state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+// The SoA view of instance i inside world
+static EdgeList instanceView(const InstanceSet *set, int i) {
+    const EdgeList *rest = &set->rest[set->dimension[i]];
+    return (EdgeList){ rest->vertexCount, rest->edgeCount, rest->dimension, rest->stride, set->world + set->dataOffset[i], rest->edges };
+}
+
+int instanceSetCreate(InstanceSet *set, int count, int minDim, int maxDim, unsigned seed) {
+    memset(set, 0, sizeof(*set));
+    if (count < 1 || minDim < 3 || maxDim > MAX_DIMENSION || minDim > maxDim) return 0;
+
+    set->count = count;
+    set->dimension = malloc(count * sizeof(int));
+    set->position = malloc(count * 3 * sizeof(float));
+    set->scale = malloc(count * sizeof(float));
+    set->angles = calloc(count, sizeof(AngleList));
+    set->velocity = calloc(count, sizeof(AngleList));
+    set->dataOffset = malloc(count * sizeof(int));
+    set->vertexOffset = malloc(count * sizeof(int));
+    set->edgeOffset = malloc(count * sizeof(int));
+    set->clip = calloc(count, sizeof(ClipStats));
+    if (!set->dimension || !set->position || !set->scale || !set->angles || !set->velocity || !set->dataOffset ||
+        !set->vertexOffset || !set->edgeOffset || !set->clip) {
+        instanceSetFree(set);
+        return 0;
+    }
+
+    // Square grid in the xy plane, each cell a little wider than a cube
+    int side = (int)ceilf(sqrtf((float)count));
+    float cell = 1.8f / side;
+    unsigned state = seed ? seed : 1;
+    size_t floats = 0, vertices = 0, edges = 0;
+    for (int i = 0; i < count; i++) {
+        int dim = minDim + (int)(randomUnit(&state) * (maxDim - minDim + 1));
+        if (dim > maxDim) dim = maxDim;
+        set->dimension[i] = dim;
+        if (!set->rest[dim].data) set->rest[dim] = *cubeMesh(dim);
+
+        set->position[i * 3 + 0] = -0.9f + cell * (i % side + 0.5f);
+        set->position[i * 3 + 1] = -0.9f + cell * (i / side + 0.5f);
+        set->position[i * 3 + 2] = (randomUnit(&state) - 0.5f) * cell;
+        set->scale[i] = cell * 0.6f;
+        for (int p = 0; p < planeCount(dim); p++) {
+            set->angles[i].plane[p] = randomUnit(&state) * 6.2831853f;
+            set->velocity[i].plane[p] = (randomUnit(&state) * 2.0f - 1.0f) * 1.5f;
+        }
+
+        set->dataOffset[i] = (int)floats;
+        set->vertexOffset[i] = (int)vertices;
+        set->edgeOffset[i] = (int)edges;
+        floats += (size_t)dim * set->rest[dim].stride;
+        vertices += set->rest[dim].vertexCount;
+        edges += set->rest[dim].edgeCount;
+        if (floats > INT_MAX || vertices + edges * 2 > INT_MAX) {
+            instanceSetFree(set);
+            return 0;
+        }
+    }
+
+    // One block holds every instance; each starts on a padded stride, so the
+    // aligned transform kernels work on it directly
+    set->vertexCount = (int)vertices;
+    set->totalEdgeCount = (int)edges;
+    set->world = allocVertexData(1, (int)floats);
+    set->projected = malloc((vertices + edges * 2) * sizeof(Proj));
+    set->edges = malloc(edges * 2 * sizeof(int));
+    set->codes = malloc(vertices);
+    if (!set->world || !set->projected || !set->edges || !set->codes) {
+        instanceSetFree(set);
+        return 0;
+    }
+
+    return 1;
+}
+
+void instanceSetFree(InstanceSet *set) {
+    free(set->dimension);
+    free(set->position);
+    free(set->scale);
+    free(set->angles);
+    free(set->velocity);
+    free(set->dataOffset);
+    free(set->vertexOffset);
+    free(set->edgeOffset);
+    free(set->clip);
+    freeVertexData(set->world);
+    free(set->projected);
+    free(set->edges);
+    free(set->codes);
+    memset(set, 0, sizeof(*set));
+}
+
+static void transformInstance(void *ctx, int i) {
+    const InstanceJob *job = ctx;
+    InstanceSet *set = job->set;
+    int dim = set->dimension[i];
+    float matrix[MAX_DIMENSION * MAX_DIMENSION];
+
+    // Scale folds into the rotation
+    frameComposeRotation(&set->angles[i], dim, matrix);
+    for (int k = 0; k < dim * dim; k++) matrix[k] *= set->scale[i];
+    EdgeList view = instanceView(set, i);
+    transformVerticesN(matrix, &set->rest[dim], &view);
+
+    // Angles stay absolute here since every instance has its own seeded
+    // spin, but are wrapped so long runs keep full float precision
+    for (int p = 0; p < planeCount(dim); p++)
+        set->angles[i].plane[p] = remainderf(set->angles[i].plane[p] + job->dt * set->velocity[i].plane[p], 6.2831853f);
+}
+
+// Each instance is brought down to 3D around its own origin before being
+// placed, so higher-dimensional instances keep their grid position instead
+// of being pulled toward the centre by the hyper perspective divide. Its
+// clipped edges land in its own slice of edges, packed afterwards.
+static void projectInstance(void *ctx, int i) {
+    const InstanceJob *job = ctx;
+    InstanceSet *set = job->set;
+    EdgeList view = instanceView(set, i);
+    float local[3 * (1 << MAX_DIMENSION)];
+    EdgeList placed = { view.vertexCount, 0, 3, view.stride, local, NULL };
+
+    if (job->perspective && view.dimension > 3) collapseHyperBatch(job->cam, &view, local);
+    else memcpy(local, view.data, 3 * view.stride * sizeof(float));
+    for (int axis = 0; axis < 3; axis++) {
+        float offset = set->position[i * 3 + axis];
+        float *plane = local + axis * view.stride;
+        for (int v = 0; v < view.vertexCount; v++) plane[v] += offset;
+    }
+    Proj *projected = set->projected + set->vertexOffset[i];
+    frameProject(job->cam, job->perspective, &placed, projected);
+
+    int createdBase = set->vertexCount + set->edgeOffset[i] * 2;
+    set->clip[i] = clipEdges(job->cam, job->perspective, &view, set->position + i * 3, projected, set->vertexOffset[i],
+                             set->projected + createdBase, createdBase, set->edges + set->edgeOffset[i] * 2,
+                             set->codes + set->vertexOffset[i]);
+}
+
+void instanceSetTransform(InstanceSet *set, ThreadPool *pool, float dt) {
+    InstanceJob job = { set, dt, NULL, 0 };
+    threadPoolRunStealing(pool, transformInstance, &job, set->count, INSTANCE_GRAIN);
+}
+
+void instanceSetProject(InstanceSet *set, ThreadPool *pool, const Camera *cam, int perspective) {
+    InstanceJob job = { set, 0.0f, cam, perspective };
+    threadPoolRunStealing(pool, projectInstance, &job, set->count, INSTANCE_GRAIN);
+
+    // Slices only ever move down, so packing in place is safe
+    int visible = 0;
+    set->clippedEdges = set->culledEdges = 0;
+    for (int i = 0; i < set->count; i++) {
+        const ClipStats *clip = &set->clip[i];
+        if (visible != set->edgeOffset[i])
+            memmove(set->edges + visible * 2, set->edges + set->edgeOffset[i] * 2, clip->visible * 2 * sizeof(int));
+        visible += clip->visible;
+        set->clippedEdges += clip->clipped;
+        set->culledEdges += clip->culled;
+    }
+    set->edgeCount = visible;
+}
@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <lod.h>
+
+// Marks a point outside the grid, which no snapped point can equal
+#define OFF_GRID 0xFFFFFFFFu
+
+// Grid cell of a point, each axis biased into 16 bits. Clipping keeps
+// endpoints within CLIP_MARGIN of the viewport, which fits whenever the
+// viewport is under 65535 cells across; a point beyond the grid is left
+// off it rather than clamped onto its border, so edges there are never
+// merged or dropped. Truncating the biased value floors it without a libm
+// call, and the selects below keep the vertex loop branch-free.
+static inline uint32_t snapAxis(float q) {
+    q = q >= 0.0f ? q : 0.0f;
+    return (uint32_t)(q < 65535.0f ? q : 65535.0f);
+}
+
+static inline uint32_t snapPoint(Proj p, float inverseCell) {
+    float x = p.x * inverseCell + 32768.0f, y = p.y * inverseCell + 32768.0f;
+    int inside = (x >= 0.0f) & (x < 65535.0f) & (y >= 0.0f) & (y < 65535.0f);
+    uint32_t cell = snapAxis(x) << 16 | snapAxis(y);
+    return inside ? cell : OFF_GRID;
+}
+
+static int reserve(EdgeLod *lod, int vertexCount, int edgeCount) {
+    if (lod->cellCapacity < vertexCount) {
+        free(lod->cells);
+        lod->cells = malloc((size_t)vertexCount * sizeof(uint32_t));
+        lod->cellCapacity = lod->cells ? vertexCount : 0;
+        if (!lod->cells) return 0;
+    }
+    if (lod->capacity >= edgeCount * 2) return 1;
+    int capacity = lod->capacity ? lod->capacity : 1024;
+    while (capacity < edgeCount * 2) capacity *= 2;
+    EdgeLodSlot *slots = calloc(capacity, sizeof(EdgeLodSlot));
+    if (!slots) return 0;
+    free(lod->slots);
+    lod->slots = slots;
+    lod->capacity = capacity;
+    return 1;
+}
+
+LodStats edgeLodReduce(EdgeLod *lod, const Proj *projected, int vertexCount, const int *edges, int edgeCount,
+                       float cell, int *out) {
+    LodStats stats = { edgeCount, 0, 0, 0 };
+    if (!reserve(lod, vertexCount, edgeCount) || cell <= 0.0f) {
+        if (out != edges) memmove(out, edges, (size_t)edgeCount * 2 * sizeof(int));
+        stats.drawn = edgeCount;
+        return stats;
+    }
+    // A new stamp empties the set without touching it; only a wrap clears
+    if (++lod->stamp == 0) {
+        memset(lod->slots, 0, (size_t)lod->capacity * sizeof(EdgeLodSlot));
+        lod->stamp = 1;
+    }
+
+    // Vertices are snapped once up front rather than once per edge end;
+    // endpoints made by clipping are snapped as they come
+    float inverseCell = 1.0f / cell;
+    uint32_t *cells = lod->cells;
+    for (int i = 0; i < vertexCount; i++) cells[i] = snapPoint(projected[i], inverseCell);
+    EdgeLodSlot *slots = lod->slots;
+    uint32_t mask = (uint32_t)lod->capacity - 1, stamp = lod->stamp;
+    int shift = 64;
+    for (int c = lod->capacity; c > 1; c >>= 1) shift--;
+    for (int i = 0; i < edgeCount; i++) {
+        int a = edges[i * 2], b = edges[i * 2 + 1];
+        uint32_t p = a < vertexCount ? cells[a] : snapPoint(projected[a], inverseCell);
+        uint32_t q = b < vertexCount ? cells[b] : snapPoint(projected[b], inverseCell);
+        if (p == OFF_GRID || q == OFF_GRID) {
+            out[stats.drawn * 2] = a;
+            out[stats.drawn * 2 + 1] = b;
+            stats.drawn++;
+            continue;
+        }
+        if (p == q) {
+            stats.degenerate++;
+            continue;
+        }
+        // Either direction is the same segment
+        uint64_t key = p < q ? (uint64_t)p << 32 | q : (uint64_t)q << 32 | p;
+        uint32_t slot = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> shift);
+        while (slots[slot].stamp == stamp && slots[slot].key != key) slot = (slot + 1) & mask;
+        if (slots[slot].stamp == stamp) {
+            stats.merged++;
+            continue;
+        }
+        slots[slot].stamp = stamp;
+        slots[slot].key = key;
+        out[stats.drawn * 2] = a;
+        out[stats.drawn * 2 + 1] = b;
+        stats.drawn++;
+    }
+    return stats;
+}
+
+void edgeLodFree(EdgeLod *lod) {
+    free(lod->slots);
+    free(lod->cells);
+    lod->slots = NULL;
+    lod->cells = NULL;
+    lod->capacity = lod->cellCapacity = 0;
+}
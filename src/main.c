@@ -1,11 +1,4 @@
-#define NK_INCLUDE_FIXED_TYPES
-#define NK_INCLUDE_STANDARD_IO
-#define NK_INCLUDE_STANDARD_VARARGS
-#define NK_INCLUDE_DEFAULT_ALLOCATOR
-
-#define NK_INCLUDE_FONT_BAKING
-#define NK_INCLUDE_DEFAULT_FONT
-#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
+#include <nk_config.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,22 +17,125 @@
 #include "nuklear_glfw_gl3.h"
 
 #include <types.h>
+#include <math3d.h>
+#include <polytope.h>
+#include <simulation.h>
+#include <trace.h>
+#include <timer.h>
+#include <headless.h>
+#include <export.h>
+#include <renderer.h>
+
+// Sized for Nuklear's whole 16-bit vertex range (20-byte GL3 vertices)
+#define MAX_VERTEX_BUFFER 1280 * 1024
+#define MAX_ELEMENT_BUFFER 384 * 1024
+// Vertices left for the wireframe once the control panels are drawn
+#define LINE_VERTEX_BUDGET 60000
+#define AA_LINE_VERTICES 8
+#define LINE_VERTICES 4
+// Longest the loop sleeps between redraws while nothing is moving
+#define IDLE_WAIT_SECONDS 0.5
+// Frame-time histogram: 1 ms columns, the last one collecting everything slower
+#define FRAME_TIME_BUCKETS 34
+#define DEFAULT_TRACE_PATH "cube-trace.json"
+
+// Frame times plus input-to-photon latency, the simulation's tick timing
+// and the trace recording controls
+static void frameTimePanel(struct nk_context *ctx, const FrameTimes *times, const FrameTimes *latency, const SimulationSnapshot *snap,
+                           double tickRate, int *interpolate, float winHeight, const char *tracePath) {
+    if (nk_begin(ctx, "Frame Times", nk_rect(10, winHeight - 250, 290, 240), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
+        float sorted[TRACE_FRAME_HISTORY];
+        int count = frameTimesSorted(latency, sorted);
+        nk_layout_row_dynamic(ctx, 15, 1);
+        if (count) nk_labelf(ctx, NK_TEXT_LEFT, "latency median %.1f  p99 %.1f ms", sorted[count / 2], sorted[(int)ceilf(count * 0.99f) - 1]);
+        else nk_label(ctx, "latency: no input yet", NK_TEXT_LEFT);
+        nk_labelf(ctx, NK_TEXT_LEFT, "tick %.0f Hz  %.2f ms  late %.2f  dropped %d", tickRate, snap->tickMs, snap->lateMs, snap->droppedTicks);
+
+        count = frameTimesSorted(times, sorted);
+        int buckets[FRAME_TIME_BUCKETS] = {0}, tallest = 1;
+        for (int i = 0; i < count; i++) {
+            int b = (int)sorted[i];
+            buckets[b < FRAME_TIME_BUCKETS ? b : FRAME_TIME_BUCKETS - 1]++;
+        }
+        for (int b = 0; b < FRAME_TIME_BUCKETS; b++) if (buckets[b] > tallest) tallest = buckets[b];
+
+        if (count) nk_labelf(ctx, NK_TEXT_LEFT, "frame median %.2f  p99 %.2f  max %.2f ms", sorted[count / 2],
+                             sorted[(int)ceilf(count * 0.99f) - 1], sorted[count - 1]);
+        else nk_label(ctx, "no frames yet", NK_TEXT_LEFT);
+        nk_layout_row_dynamic(ctx, 70, 1);
+        if (nk_chart_begin(ctx, NK_CHART_COLUMN, FRAME_TIME_BUCKETS, 0, (float)tallest)) {
+            for (int b = 0; b < FRAME_TIME_BUCKETS; b++) nk_chart_push(ctx, (float)buckets[b]);
+            nk_chart_end(ctx);
+        }
+        nk_layout_row_dynamic(ctx, 20, 3);
+        nk_checkbox_label(ctx, "Interpolate", interpolate);
+        int recording = traceEnabled();
+        if (nk_checkbox_label(ctx, "Record", &recording)) traceSetEnabled(recording);
+        if (nk_button_label(ctx, "Save trace")) {
+            if (traceWriteChrome(tracePath)) printf("Trace written to %s\n", tracePath);
+            else fprintf(stderr, "Failed to write %s\n", tracePath);
+        }
+    }
+    nk_end(ctx);
+}
 
-#define MAX_VERTEX_BUFFER 512 * 1024
-#define MAX_ELEMENT_BUFFER 128 * 1024
+// Uploads the software framebuffer into texture, reallocating on resize
+static void uploadFramebuffer(GLuint *texture, int *texWidth, int *texHeight, const Framebuffer *fb) {
+    if (!*texture) {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    glBindTexture(GL_TEXTURE_2D, *texture);
+    if (*texWidth != fb->width || *texHeight != fb->height) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, fb->width, fb->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, fb->pixels);
+        *texWidth = fb->width;
+        *texHeight = fb->height;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fb->width, fb->height, GL_RGBA, GL_UNSIGNED_BYTE, fb->pixels);
+    }
+}
 
-// Prototypes
-Proj projectPerspective3D(float, float, float, float, float, float, float);
-Proj projectOrthoN(const float *, int, float, float, float);
-EdgeList createCubeN(int);
-void projectHyper4Dto3D(const float *pt4, int dim, float screenW, float screenH, float cam4DDistance, float fov4D, Proj *out, float cameraDistance, float fovY);
-void flatten4Dto3D(const float *pt4, float out3[3]);
-void getRotationMatrix3D(AngleList, float out[9], int);
-void getRotationMatrix4D(AngleList, float out[16], int);
-void matrixMultiplyN(const float *, EdgeList *);
+int main(int argc, char **argv) {
+    ExportOptions exportOptions;
+    int exportMode = parseExportArgs(argc, argv, &exportOptions);
+    if (exportMode < 0) return EXIT_FAILURE;
+    if (exportMode) return runExport(&exportOptions);
+
+    HeadlessOptions headless;
+    int headlessMode = parseHeadlessArgs(argc, argv, &headless);
+    if (headlessMode < 0) return EXIT_FAILURE;
+    if (headlessMode) return runHeadless(&headless);
+
+    // Each --mesh file stands in for the n-cube of its dimension. They stay
+    // mapped for the whole run, so switching to one only costs page faults.
+    // --trace records from the first frame and writes the trace on exit, and
+    // --tick-rate sets how often the simulation thread steps.
+    Polytope meshes[MAX_DIMENSION + 1] = {0};
+    int firstMesh = 0;
+    const char *tracePath = NULL;
+    double tickRate = SIMULATION_DEFAULT_TICK_RATE;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (!strcmp(argv[i], "--trace")) tracePath = argv[++i];
+        else if (!strcmp(argv[i], "--tick-rate")) {
+            tickRate = atof(argv[++i]);
+            if (tickRate < 10.0 || tickRate > 1000.0) {
+                fprintf(stderr, "--tick-rate must be 10..1000\n");
+                return EXIT_FAILURE;
+            }
+        }
+        if (strcmp(argv[i], "--mesh")) continue;
+        Polytope poly;
+        if (!polytopeOpen(&poly, argv[++i])) return EXIT_FAILURE;
+        int dim = poly.mesh.dimension;
+        polytopeClose(&meshes[dim]);
+        meshes[dim] = poly;
+        if (!firstMesh || dim < firstMesh) firstMesh = dim;
+    }
 
-int main(void) {
     printf("Starting program...\n");
+    printf("Transform backend: %s\n", transformBackendName());
     if (!glfwInit()) {
         fprintf(stderr, "Failed to init GLFW\n");
         return EXIT_FAILURE;
@@ -75,30 +171,72 @@ int main(void) {
     nk_glfw3_font_stash_end();
     nk_style_set_font(ctx, &font->handle);
 
-    AngleList angles = {0};
+    // The wireframe goes straight to GL; Nuklear's tessellated lines remain
+    // as the fallback if the line shaders cannot be built
+    LineRenderer *lines = lineRendererCreate();
+    if (!lines) fprintf(stderr, "GPU line renderer unavailable, drawing lines through Nuklear\n");
+
     double lastTime = glfwGetTime();
     float fpsAccumulator = 0.0f;
     int fpsFrameCount = 0;
-    int rotateX = 0, rotateY = 0, rotateZ = 0;
-    int rotateXY = 0, rotateXZ = 0, rotateXW = 0, rotateYZ = 0, rotateYW = 0, rotateZW = 0;
+    int rotate[MAX_PLANES] = {0};
+    const char axisNames[MAX_DIMENSION + 1] = "XYZWVUTSRQPO";
     int projectionType = 0;
+    int slice = 0;
+    float sliceOffset = 0.0f;
     float scaleFactor = 0.5f;
     float cameraDistance = 1.5f;
     float fovY = 90.0f;
     float hyperCamDistance = 1.5f;
     float hyperFov = 90.0f;
     float radianPerSecond = 50.0f * (M_PI/180.0f);
-    int dimension = 3, oldDimension = 3;
-
-    EdgeList cube = createCubeN(dimension);
-    EdgeList originalCube = createCubeN(dimension);
-    if (!cube.data || !originalCube.data) printf("Cube memory allocation failed for some reason.");
+    int dimension = firstMesh ? firstMesh : 3, oldDimension = dimension;
+    int softwareRaster = 0;
+    // Off by default: a reduced edge list is streamed every frame, while
+    // the GPU lines otherwise keep the whole topology on the GPU
+    int edgeLod = 0;
+    SoftwareRenderer *raster = NULL;
+    GLuint rasterTexture = 0;
+    int rasterTexWidth = 0, rasterTexHeight = 0;
+    int instanceCount = 0;
+    // The loop only redraws when a new snapshot arrived, the input changed or
+    // it is blending between snapshots, and sleeps otherwise
+    int idle = 0;
+    int rasterValid = 0;
+    int interpolate = 1;
+    int showFrameTimes = 0;
+    FrameTimes frameTimes = {0}, latency = {0};
+    if (tracePath) traceSetEnabled(1);
+    traceSetThreadName("main");
+
+    // Geometry runs on the simulation thread. Inputs are published whenever
+    // the UI changes them; the oldest input not yet on screen is timed until
+    // the swap that first shows it.
+    Simulation *sim = simulationCreate(meshes, tickRate, glfwPostEmptyEvent);
+    if (!sim) {
+        fprintf(stderr, "Failed to start the simulation thread\n");
+        return EXIT_FAILURE;
+    }
+    SimulationInput lastInput = {0};
+    unsigned pendingInput = 0;
+    double pendingStamp = 0.0;
 
     while (!glfwWindowShouldClose(win)) {
-        glfwPollEvents();
+        TraceZone zone = traceBegin(idle ? "wait events" : "poll events");
+        if (idle) {
+            glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+            // Time spent asleep must not turn into a jump once rotation resumes
+            lastTime = glfwGetTime();
+        } else {
+            glfwPollEvents();
+        }
+        traceEnd(&zone);
+
+        // Frame time counts the work after events, not the idle wait
+        double frameStart = timerNow();
+        zone = traceBegin("ui");
         nk_glfw3_new_frame();
 
-        float rotationMatrix[16];
         int frameBufferWidth, frameBufferHeight, winWidth, winHeight;
         glfwGetFramebufferSize(win, &frameBufferWidth, &frameBufferHeight);
         glViewport(0, 0, frameBufferWidth, frameBufferHeight);
@@ -107,7 +245,6 @@ int main(void) {
         float now = glfwGetTime();
         float dt = (float)(now - lastTime);
         lastTime = now;
-        float fps = 1.0f/(dt>0.0001f?dt:0.0001f);
 
         fpsAccumulator += dt;
         fpsFrameCount++;
@@ -121,20 +258,24 @@ int main(void) {
             fpsAccumulator -= 1.0f;
             fpsFrameCount = 0;
         }
-        memcpy(cube.data, originalCube.data, cube.edgeCount * 2 * cube.dimension * sizeof(float)); // reset cube
 
-        if (nk_begin(ctx, "Dimension Controls", nk_rect(10, 10, 150, 70), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
+        if (nk_begin(ctx, "Dimension Controls", nk_rect(10, 10, 150, 160), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
             nk_layout_row_dynamic(ctx, 25, 1);
-            nk_property_int(ctx, "Dimension:", 3, &dimension, 5, 1, 10.0f);
+            nk_property_int(ctx, "Dimension:", 3, &dimension, MAX_DIMENSION, 1, 10.0f);
+            nk_property_int(ctx, "Instances:", 0, &instanceCount, 50000, 100, 50.0f);
+            nk_layout_row_dynamic(ctx, 15, 1);
+            nk_checkbox_label(ctx, "CPU Raster", &softwareRaster);
+            nk_checkbox_label(ctx, "Frame Times", &showFrameTimes);
+            nk_checkbox_label(ctx, "Edge LOD", &edgeLod);
         }
         nk_end(ctx);
 
         if (dimension == 3) {
             if (nk_begin(ctx, "3D Rotation Controls", nk_rect(170, 10, 170, 90), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
                 nk_layout_row_dynamic(ctx, 10, 1);
-                nk_checkbox_label(ctx, "Rotate X", &rotateX);
-                nk_checkbox_label(ctx, "Rotate Y", &rotateY);
-                nk_checkbox_label(ctx, "Rotate Z", &rotateZ);
+                nk_checkbox_label(ctx, "Rotate X", &rotate[1]);
+                nk_checkbox_label(ctx, "Rotate Y", &rotate[2]);
+                nk_checkbox_label(ctx, "Rotate Z", &rotate[0]);
             }
             nk_end(ctx);
 
@@ -147,21 +288,44 @@ int main(void) {
                 }
             }
             nk_end(ctx);
-        } else if (dimension == 4) {
-            if (nk_begin(ctx, "4D Rotation Controls", nk_rect(170, 10, 170, 90), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
-                nk_layout_row_dynamic(ctx, 10, 2);
-                nk_checkbox_label(ctx, "XY", &rotateXY);
-                nk_checkbox_label(ctx, "XZ", &rotateXZ);
-                nk_checkbox_label(ctx, "XW", &rotateXW);
-                nk_checkbox_label(ctx, "YZ", &rotateYZ);
-                nk_checkbox_label(ctx, "YW", &rotateYW);
-                nk_checkbox_label(ctx, "ZW", &rotateZW);
+        } else {
+            // One checkbox per rotation plane, laid out in columns
+            char title[64];
+            int planes = planeCount(dimension);
+            int columns = dimension == 4 ? 2 : 4;
+            int rows = (planes + columns - 1) / columns;
+            float rotationWidth = columns == 2 ? 170 : 290;
+
+            snprintf(title, sizeof(title), "%dD Rotation Controls", dimension);
+            if (nk_begin(ctx, title, nk_rect(170, 10, rotationWidth, 48 + rows * 14), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
+                nk_layout_row_dynamic(ctx, 10, columns);
+                for (int p = 0; p < planes; p++) {
+                    int a, b;
+                    planeAxes(dimension, p, &a, &b);
+                    char label[3] = { axisNames[a], axisNames[b], '\0' };
+                    nk_checkbox_label(ctx, label, &rotate[p]);
+                }
             }
             nk_end(ctx);
 
-            if (nk_begin(ctx, "4D Projection Controls", nk_rect(350, 10, 200, !projectionType ? 60 : 135), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
+            // Slicing cuts the mesh at x[n-1] = offset and projects the
+            // (n-1)-D cross-section with the controls below
+            snprintf(title, sizeof(title), "%dD Projection Controls", dimension);
+            float projectionHeight = (!projectionType ? 80 : 155) + (slice && !instanceCount ? 19 : 0);
+            if (nk_begin(ctx, title, nk_rect(180 + rotationWidth, 10, 200, projectionHeight), NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR)) {
                 nk_layout_row_dynamic(ctx, 15, 1);
                 nk_checkbox_label(ctx, "Perspective", &projectionType);
+                char sliceLabel[32];
+                snprintf(sliceLabel, sizeof(sliceLabel), "Slice %c = %.2f", axisNames[dimension - 1], sliceOffset);
+                // The instance grid has no single mesh to cut, so the
+                // setting waits until instances are off again
+                if (instanceCount) nk_label(ctx, "Slice: off with instances", NK_TEXT_LEFT);
+                else nk_checkbox_label(ctx, sliceLabel, &slice);
+                if (slice && !instanceCount) {
+                    // Far enough to leave the cube through a vertex
+                    float reach = 0.5f * sqrtf((float)dimension);
+                    nk_slider_float(ctx, -reach, &sliceOffset, reach, 0.01f);
+                }
                 if (projectionType) {
                     nk_property_float(ctx, "Distance", 0.1f, &cameraDistance, 10, 0.1f, 0.1f);
                     nk_property_float(ctx, "Hyper Distance", 0.1f, &hyperCamDistance, 10, 0.1f, 0.1f);
@@ -172,262 +336,151 @@ int main(void) {
             nk_end(ctx);
         }
 
+        // A new dimension starts with every plane still
         if (dimension != oldDimension) {
-            free(cube.data);
-            free(originalCube.data);
-            cube = createCubeN(dimension);
-            originalCube = createCubeN(dimension);
-            if (oldDimension == 3) {
-                rotateX = 0; rotateY = 0; rotateZ = 0;
-                angles.x = 0.0f; angles.y = 0.0f; angles.z = 0.0f;
-            } else if (oldDimension == 4) {
-                rotateXW = 0; rotateXY = 0; rotateXZ = 0; rotateYW = 0; rotateYZ = 0; rotateZW = 0;
-                angles.u = 0.0f; angles.v = 0.0f; angles.w = 0.0f; angles.x = 0.0f; angles.y = 0.0f; angles.z = 0.0f;
-            }
+            memset(rotate, 0, sizeof(rotate));
             projectionType = 0;
-            oldDimension = dimension;
+            slice = 0;
+            sliceOffset = 0.0f;
         }
-
-        if (dimension == 3) {
-            for (int i = 0; i < dimension; i++) {
-                getRotationMatrix3D(angles, rotationMatrix, i);
-                matrixMultiplyN(rotationMatrix, &cube);
+        oldDimension = dimension;
+
+        SimulationInput input = { dimension, instanceCount, {0}, radianPerSecond,
+                                  { projectionType, scaleFactor, cameraDistance, fovY, hyperCamDistance, hyperFov, winWidth, winHeight,
+                                    slice, sliceOffset, edgeLod },
+                                  0 };
+        memcpy(input.rotate, rotate, sizeof(rotate));
+        int inputChanged = !simulationInputEqual(&input, &lastInput);
+        if (inputChanged) {
+            input.sequence = simulationSetInput(sim, &input);
+            if (!pendingInput) {
+                pendingInput = input.sequence;
+                pendingStamp = frameStart;
             }
-            if (rotateX) angles.x += dt * radianPerSecond;
-            if (rotateY) angles.y += dt * radianPerSecond;
-            if (rotateZ) angles.z += dt * radianPerSecond;
-        } else if (dimension == 4) {
-            float mat4[16];
-            getRotationMatrix4D(angles, mat4, 0); matrixMultiplyN(mat4, &cube);
-            getRotationMatrix4D(angles, mat4, 1); matrixMultiplyN(mat4, &cube);
-            getRotationMatrix4D(angles, mat4, 2); matrixMultiplyN(mat4, &cube);
-            getRotationMatrix4D(angles, mat4, 3); matrixMultiplyN(mat4, &cube);
-            getRotationMatrix4D(angles, mat4, 4); matrixMultiplyN(mat4, &cube);
-            getRotationMatrix4D(angles, mat4, 5); matrixMultiplyN(mat4, &cube);
-
-            if (rotateXY) angles.u += dt * radianPerSecond;
-            if (rotateXZ) angles.v += dt * radianPerSecond;
-            if (rotateXW) angles.w += dt * radianPerSecond;
-            if (rotateYZ) angles.x += dt * radianPerSecond;
-            if (rotateYW) angles.y += dt * radianPerSecond;
-            if (rotateZW) angles.z += dt * radianPerSecond;
+            lastInput = input;
         }
-
-        if (nk_begin(ctx, "Canvas", nk_rect(0, 0, (float)winWidth, (float)winHeight), NK_WINDOW_NO_SCROLLBAR | NK_WINDOW_BACKGROUND)) {
-            struct nk_command_buffer *canvas = nk_window_get_canvas(ctx);
-            Proj zero, one;
-            float start3D[3], end3D[3];
-            for (int i = 0; i < cube.edgeCount; i++) {
-                if (projectionType && dimension == 3) {
-                    float *start = cube.data + ((i * 2 + 0) * 3);
-                    float *end = cube.data + ((i * 2 + 1) * 3);
-                    zero = projectPerspective3D(start[0], start[1], start[2], winWidth, winHeight, cameraDistance, fovY);
-                    one  = projectPerspective3D(end[0], end[1], end[2], winWidth, winHeight, cameraDistance, fovY);
-
-                } else if (projectionType && dimension == 4) {
-                    float *start4D = cube.data + ((i * 2 + 0 ) * 4);
-                    float *end4D = cube.data + ((i * 2 + 1) * 4);
-                    projectHyper4Dto3D(start4D, 4, winWidth, winHeight, hyperCamDistance, hyperFov, &zero, cameraDistance, fovY);
-                    projectHyper4Dto3D(end4D, 4, winWidth, winHeight, hyperCamDistance, hyperFov, &one, cameraDistance, fovY);
-                
+        traceEnd(&zone);
+
+        // Take the newest snapshot and, while animating, draw it one tick in
+        // the past blended from the one before, so motion stays even however
+        // the tick and refresh rates line up
+        zone = traceBegin("consume");
+        int fresh = simulationAcquire(sim);
+        const SimulationSnapshot *snap = simulationCurrent(sim);
+        int blending = interpolate && snap->animating;
+        const Proj *drawVerts = blending ? simulationInterpolate(sim, timerNow() - simulationTickPeriod(sim)) : snap->projected;
+        traceEnd(&zone);
+        idle = !fresh && !inputChanged && !snap->animating;
+
+        // The instance count comes back as 0 when the scene could not be built
+        if (fresh && snap->inputSequence == lastInput.sequence && snap->instanceCount != lastInput.instanceCount)
+            instanceCount = snap->instanceCount;
+        const int *edges = snap->edges;
+        int edgeCount = snap->edgeCount;
+        float thickness = snap->instanceCount ? 1.5f : 5.0f;
+
+        if (softwareRaster && !raster) {
+            raster = softwareRendererCreate(winWidth, winHeight, 0);
+            if (!raster) softwareRaster = 0;
+            rasterValid = 0;
+        }
+        if (!softwareRaster) rasterValid = 0;
+
+        // Nuklear indexes its draw list with 16-bit indices, so the wireframe
+        // has to fit what is left of that range after the panels. The GPU
+        // line renderer and the CPU rasterizer bypass its draw list and have
+        // no limit.
+        int gpuLines = lines && !softwareRaster;
+        int antiAliased = softwareRaster || gpuLines || edgeCount * AA_LINE_VERTICES <= LINE_VERTEX_BUDGET;
+        int drawnEdges = softwareRaster || gpuLines ? edgeCount : LINE_VERTEX_BUDGET / (antiAliased ? AA_LINE_VERTICES : LINE_VERTICES);
+        if (drawnEdges > edgeCount) drawnEdges = edgeCount;
+
+        // Edges that reached the level of detail against those drawn
+        float counterY = 180;
+        if (edgeLod) {
+            if (nk_begin(ctx, "Edge LOD", nk_rect(10, counterY, 150, 58), NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR)) {
+                nk_layout_row_dynamic(ctx, 15, 1);
+                nk_labelf(ctx, NK_TEXT_LEFT, "Submitted: %d", edgeCount + snap->lodMerged + snap->lodDegenerate);
+                nk_labelf(ctx, NK_TEXT_LEFT, "Drawn: %d", drawnEdges);
+            }
+            nk_end(ctx);
+            counterY += 65;
+        }
+        if (drawnEdges < edgeCount) {
+            if (nk_begin(ctx, "Edge Budget", nk_rect(10, counterY, 150, 40), NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR)) {
+                nk_layout_row_dynamic(ctx, 15, 1);
+                nk_labelf(ctx, NK_TEXT_LEFT, "Edges: %d / %d", drawnEdges, edgeCount);
+            }
+            nk_end(ctx);
+        }
+        if (showFrameTimes)
+            frameTimePanel(ctx, &frameTimes, &latency, snap, tickRate, &interpolate, (float)winHeight, tracePath ? tracePath : DEFAULT_TRACE_PATH);
+
+        if (gpuLines) {
+            // Only positions are streamed while the snapshot holds the whole
+            // topology; endpoints made by clipping follow the vertices
+            zone = traceBegin("emit");
+            int complete = !snap->clippedEdges && !snap->culledEdges && !snap->sliced && !snap->lodMerged && !snap->lodDegenerate;
+            int streamed = snap->vertexCount + (snap->clippedEdges ? 2 * snap->totalEdgeCount : 0);
+            lineRendererClear(lines, RGBA(45, 45, 45, 255));
+            // Vertices are in window units, the viewport in framebuffer pixels
+            float pixelScale = winWidth > 0 ? (float)frameBufferWidth / winWidth : 1.0f;
+            lineRendererDraw(lines, drawVerts, streamed, edges, edgeCount, complete, snap->generation,
+                             (float)frameBufferWidth, (float)frameBufferHeight, pixelScale, thickness,
+                             RGBA(200, 200, 200, 255));
+            traceEnd(&zone);
+        } else {
+            if (nk_begin(ctx, "Canvas", nk_rect(0, 0, (float)winWidth, (float)winHeight), NK_WINDOW_NO_SCROLLBAR | NK_WINDOW_BACKGROUND)) {
+                struct nk_command_buffer *canvas = nk_window_get_canvas(ctx);
+                if (softwareRaster && softwareRendererResize(raster, winWidth, winHeight)) {
+                    // The last uploaded image stays valid until the projection moves
+                    if (fresh || blending || !rasterValid) {
+                        zone = traceBegin("raster");
+                        softwareRendererDraw(raster, drawVerts, edges, edgeCount, thickness, RGBA(200, 200, 200, 255), RGBA(45, 45, 45, 255));
+                        uploadFramebuffer(&rasterTexture, &rasterTexWidth, &rasterTexHeight, softwareRendererFramebuffer(raster));
+                        rasterValid = 1;
+                        traceEnd(&zone);
+                    }
+                    struct nk_image image = nk_image_id((int)rasterTexture);
+                    nk_draw_image(canvas, nk_rect(0, 0, (float)winWidth, (float)winHeight), &image, nk_rgb(255, 255, 255));
                 } else {
-                    float *startN = cube.data + ((i * 2 + 0) * cube.dimension);
-                    float *endN = cube.data + ((i * 2 + 1) * cube.dimension);
-                    if (dimension == 4) {
-                        flatten4Dto3D(startN, start3D);
-                        flatten4Dto3D(endN, end3D);
+                    zone = traceBegin("emit");
+                    for (int i = 0; i < drawnEdges; i++) {
+                        Proj zero = drawVerts[edges[i * 2 + 0]];
+                        Proj one  = drawVerts[edges[i * 2 + 1]];
+                        nk_stroke_line(canvas, zero.x, zero.y, one.x, one.y, thickness, nk_rgb(200, 200, 200));
                     }
-                    zero = projectOrthoN(dimension == 3 ? startN : start3D, 3, winWidth, winHeight, scaleFactor);
-                    one  = projectOrthoN(dimension == 3 ? endN : end3D, 3, winWidth, winHeight, scaleFactor);
+                    traceEnd(&zone);
                 }
-
-                nk_stroke_line(canvas, zero.x, zero.y, one.x, one.y, 5.0f, nk_rgb(200, 200, 200));
             }
+            nk_end(ctx);
         }
-        nk_end(ctx);
 
-        nk_glfw3_render(NK_ANTI_ALIASING_ON, MAX_VERTEX_BUFFER, MAX_ELEMENT_BUFFER);
+        zone = traceBegin("render");
+        nk_glfw3_render(antiAliased ? NK_ANTI_ALIASING_ON : NK_ANTI_ALIASING_OFF, MAX_VERTEX_BUFFER, MAX_ELEMENT_BUFFER);
+        traceEnd(&zone);
+        zone = traceBegin("swap");
         glfwSwapBuffers(win);
+        traceEnd(&zone);
+        double presented = timerNow();
+        frameTimesAdd(&frameTimes, (float)((presented - frameStart) * 1e3));
+        if (pendingInput && snap->inputSequence >= pendingInput) {
+            frameTimesAdd(&latency, (float)((presented - pendingStamp) * 1e3));
+            pendingInput = 0;
+        }
     }
+    if (tracePath && !traceWriteChrome(tracePath)) fprintf(stderr, "Failed to write %s\n", tracePath);
+    simulationDestroy(sim);
+    softwareRendererDestroy(raster);
+    lineRendererDestroy(lines);
+    if (rasterTexture) glDeleteTextures(1, &rasterTexture);
     nk_glfw3_shutdown();
     glfwDestroyWindow(win);
     glfwTerminate();
-    free(cube.data);
-    free(originalCube.data);
+    for (int d = 0; d <= MAX_DIMENSION; d++) polytopeClose(&meshes[d]);
     return EXIT_SUCCESS;
 }
 
-EdgeList createCubeN(int dimension) {
-    EdgeList list = {0};
-    int verts = 1 << dimension;
-    int edges = dimension * (1 << (dimension - 1));
-
-    float *coords = malloc(verts * dimension * sizeof(float));
-    float *edgeData = malloc(edges * 2 * dimension * sizeof(float));
-    if (!coords || !edgeData) {
-        free(coords);
-        free(edgeData);
-        return list;
-    }
-
-    for (int v = 0; v < verts; ++v)
-      for (int d = 0; d < dimension; ++d)
-        coords[v*dimension + d] = (v & (1<<d)) ? +0.5f : -0.5f;
-
-    int idx = 0;
-    for (int v = 0; v < verts; ++v) {
-      for (int d = 0; d < dimension; ++d) {
-        int nb = v ^ (1 << d);
-        if (v < nb) {
-          memcpy(&edgeData[idx * 2 * dimension], &coords[v * dimension], dimension * sizeof(float));
-          memcpy(&edgeData[idx * 2 * dimension + dimension], &coords[nb * dimension], dimension * sizeof(float));
-          ++idx;
-        }
-      }
-    }
-
-    free(coords);
-    list.edgeCount = edges;
-    list.dimension = dimension;
-    list.data = edgeData;
-    return list;
-}
-
-Proj projectOrthoN(const float *pt, int dimension, float screenW, float screenH, float scaleFactor) {
-    float x = (dimension > 0 ? pt[0] : 0.0f);
-    float y = (dimension > 1 ? pt[1] : 0.0f);
-
-    return (Proj){ x * screenW  * scaleFactor + (screenW  * 0.5f), y * screenH  * scaleFactor + (screenH  * 0.5f) };
-}
-
-Proj projectPerspective3D(float x, float y, float z, float screenW, float screenH, float camDistance, float fovY) {
-    float aspectRatio = screenW / screenH;
-    float fovY_radius = fovY * M_PI / 180.0f;
-    float f = 1.0f / tan(fovY_radius / 2.0f);
-    float zCameraOffset = z + camDistance;
-    if (zCameraOffset < 0.01f) zCameraOffset = 0.01f;
-
-    float xNormalizedDeviceCoords = (x * f / aspectRatio) / zCameraOffset;
-    float yNormalizedDeviceCoords = (y * f) / zCameraOffset;
-
-    float screenX = (xNormalizedDeviceCoords * 0.5f + 0.5f) * screenW;
-    float screenY = (1.0f - (yNormalizedDeviceCoords * 0.5f + 0.5f)) * screenH; 
-
-    return (Proj){screenX, screenY};
-}
-
-void projectHyper4Dto3D(const float *pt4, int dim, float screenW, float screenH, float cam4DDistance, float fov4D, Proj *out, float cameraDistance, float fovY) {
-    float f4 = 1.0f / tanf(fov4D * (M_PI/180.0f) * 0.5f);
-    float wOffset = cam4DDistance + pt4[3];
-    if (wOffset < 0.01f) wOffset = 0.01f;
-    float x3 = (pt4[0]*f4/ ((float)screenW / screenH)) / wOffset;
-    float y3 = (pt4[1]*f4) / wOffset;
-    float z3 = (pt4[2]*f4) / wOffset;
-    *out = projectPerspective3D(x3, y3, z3, screenW, screenH, cameraDistance, fovY);
-}
-
-void flatten4Dto3D(const float *pt4, float out3[3]) {
-    out3[0] = pt4[0];
-    out3[1] = pt4[1];
-    out3[2] = pt4[2] + pt4[3];
-}
-
-void getRotationMatrix3D(AngleList angle, float out[9], int axisType) {
-    float c;
-    float s;
-    if (axisType == 0) {
-        // Visual X rotation
-        c = cosf(angle.x);
-        s = sinf(angle.x);
-        out[0] = c; out[1] = 0; out[2] = s;
-        out[3] = 0; out[4] = 1; out[5] = 0; 
-        out[6] = -s; out[7] = 0; out[8] = c; 
-    } else if (axisType == 1) {
-        // Visual Y rotation
-        c = cosf(angle.y);
-        s = sinf(angle.y);
-        out[0] = 1; out[1] = 0; out[2] = 0;
-        out[3] = 0; out[4] = c; out[5] = -s;
-        out[6] = 0; out[7] = s; out[8] = c;
-    } else {
-        // Visual Z rotation
-        c = cosf(angle.z);
-        s = sinf(angle.z);
-        out[0] =  c; out[1] = -s; out[2] =  0;
-        out[3] =  s; out[4] = c; out[5] =  0;
-        out[6] = 0; out[7] = 0; out[8] =  1;
-    }
-}
-
-void getRotationMatrix4D(AngleList angle, float out[16], int planeType) {
-    memset(out, 0, 16 * sizeof(float));
-    out[0] = 1.0f; out[5] = 1.0f; out[10] = 1.0f; out[15] = 1.0f;
-    float c, s;
-    switch (planeType) {
-        case 0: // XY‐plane
-            c = cosf(angle.u);
-            s = sinf(angle.u);
-            out[0] = c; out[1] = -s;
-            out[4] = s; out[5] = c;
-            break;
-        case 1: // XZ‐plane
-            c = cosf(angle.v);
-            s = sinf(angle.v);
-            out[0] = c; out[2] = -s;
-            out[8] = s; out[10] = c;
-            break;
-        case 2: // XW‐plane
-            c = cosf(angle.w);
-            s = sinf(angle.w);
-            out[0] = c; out[3] = -s;
-            out[12] = s; out[15] = c;
-            break;
-        case 3: // YZ‐plane
-            c = cosf(angle.x);
-            s = sinf(angle.x);
-            out[5] = c; out[6] = -s;
-            out[9] = s; out[10] = c;
-            break;
-        case 4: // YW‐plane
-            c = cosf(angle.y);
-            s = sinf(angle.y);
-            out[5] = c; out[7] = -s;
-            out[13] = s; out[15] = c;
-            break;
-        case 5: // ZW‐plane
-            c = cosf(angle.z);
-            s = sinf(angle.z);
-            out[10] = c; out[11] = -s;
-            out[14] = s; out[15] = c;
-            break;
-        default:
-        // leave as identity
-        break;
-    }
-}
-
-void matrixMultiplyN(const float *m, EdgeList *list) {
-    int edge = list->edgeCount;
-    int dim = list->dimension;
-
-    float temp[dim]; // malloc dim sized temp
-
-    for (int i = 0; i < edge; ++i) {
-        for (int j = 0; j < 2; ++j) {
-            float *points = list->data + ((i * 2 + j) * dim);
-
-            for (int k = 0; k < dim; ++k) {
-                float sum = 0.0f;
-                for (int l = 0; l < dim; ++l) {
-                    sum += m[k * dim + l] * points[l];
-                }
-                temp[k] = sum;
-            }
-            memcpy(points, temp, dim * sizeof(float));
-        }
-    }
-}
-
 /*
 Old manual implementation
 
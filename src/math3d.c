@@ -0,0 +1,159 @@
+#include <string.h>
+#include <math.h>
+
+#include <math3d.h>
+
+void matrixIdentityN(float *m, int dim) {
+    memset(m, 0, dim * dim * sizeof(float));
+    for (int i = 0; i < dim; i++) m[i * dim + i] = 1.0f;
+}
+
+void matrixRotatePlaneN(float *m, int dim, int a, int b, float angle) {
+    if (angle == 0.0f) return; // inactive plane, identity
+
+    float c = cosf(angle);
+    float s = sinf(angle);
+    float *rowA = m + a * dim;
+    float *rowB = m + b * dim;
+    for (int col = 0; col < dim; col++) {
+        float ra = rowA[col];
+        float rb = rowB[col];
+        rowA[col] = c * ra - s * rb;
+        rowB[col] = s * ra + c * rb;
+    }
+}
+
+int planeCount(int dim) {
+    return dim * (dim - 1) / 2;
+}
+
+int planeIndex(int dim, int a, int b) {
+    return a * dim - a * (a + 1) / 2 + (b - a - 1);
+}
+
+void planeAxes(int dim, int plane, int *a, int *b) {
+    int first = 0;
+    while (plane >= dim - 1 - first) {
+        plane -= dim - 1 - first;
+        first++;
+    }
+    *a = first;
+    *b = first + 1 + plane;
+}
+
+void getRotationMatrixN(const AngleList *angle, float *out, int dim, int plane) {
+    int a, b;
+    planeAxes(dim, plane, &a, &b);
+    matrixIdentityN(out, dim);
+    matrixRotatePlaneN(out, dim, a, b, angle->plane[plane]);
+}
+
+void composeRotation3D(const AngleList *angle, float out[9]) {
+    matrixIdentityN(out, 3);
+    matrixRotatePlaneN(out, 3, 0, 2, -angle->plane[1]); // Visual X rotation
+    matrixRotatePlaneN(out, 3, 1, 2, angle->plane[2]);  // Visual Y rotation
+    matrixRotatePlaneN(out, 3, 0, 1, angle->plane[0]);  // Visual Z rotation
+}
+
+void composeRotationN(const AngleList *angle, float *out, int dim) {
+    matrixIdentityN(out, dim);
+    int plane = 0;
+    for (int a = 0; a < dim; a++)
+        for (int b = a + 1; b < dim; b++, plane++)
+            matrixRotatePlaneN(out, dim, a, b, angle->plane[plane]);
+}
+
+void getRotationMatrix3D(AngleList angle, float out[9], int axisType) {
+    float c;
+    float s;
+    if (axisType == 0) {
+        // Visual X rotation
+        c = cosf(angle.plane[1]);
+        s = sinf(angle.plane[1]);
+        out[0] = c; out[1] = 0; out[2] = s;
+        out[3] = 0; out[4] = 1; out[5] = 0; 
+        out[6] = -s; out[7] = 0; out[8] = c; 
+    } else if (axisType == 1) {
+        // Visual Y rotation
+        c = cosf(angle.plane[2]);
+        s = sinf(angle.plane[2]);
+        out[0] = 1; out[1] = 0; out[2] = 0;
+        out[3] = 0; out[4] = c; out[5] = -s;
+        out[6] = 0; out[7] = s; out[8] = c;
+    } else {
+        // Visual Z rotation
+        c = cosf(angle.plane[0]);
+        s = sinf(angle.plane[0]);
+        out[0] =  c; out[1] = -s; out[2] =  0;
+        out[3] =  s; out[4] = c; out[5] =  0;
+        out[6] = 0; out[7] = 0; out[8] =  1;
+    }
+}
+
+void getRotationMatrix4D(AngleList angle, float out[16], int planeType) {
+    memset(out, 0, 16 * sizeof(float));
+    out[0] = 1.0f; out[5] = 1.0f; out[10] = 1.0f; out[15] = 1.0f;
+    float c, s;
+    switch (planeType) {
+        case 0: // XY‐plane
+            c = cosf(angle.plane[0]);
+            s = sinf(angle.plane[0]);
+            out[0] = c; out[1] = -s;
+            out[4] = s; out[5] = c;
+            break;
+        case 1: // XZ‐plane
+            c = cosf(angle.plane[1]);
+            s = sinf(angle.plane[1]);
+            out[0] = c; out[2] = -s;
+            out[8] = s; out[10] = c;
+            break;
+        case 2: // XW‐plane
+            c = cosf(angle.plane[2]);
+            s = sinf(angle.plane[2]);
+            out[0] = c; out[3] = -s;
+            out[12] = s; out[15] = c;
+            break;
+        case 3: // YZ‐plane
+            c = cosf(angle.plane[3]);
+            s = sinf(angle.plane[3]);
+            out[5] = c; out[6] = -s;
+            out[9] = s; out[10] = c;
+            break;
+        case 4: // YW‐plane
+            c = cosf(angle.plane[4]);
+            s = sinf(angle.plane[4]);
+            out[5] = c; out[7] = -s;
+            out[13] = s; out[15] = c;
+            break;
+        case 5: // ZW‐plane
+            c = cosf(angle.plane[5]);
+            s = sinf(angle.plane[5]);
+            out[10] = c; out[11] = -s;
+            out[14] = s; out[15] = c;
+            break;
+        default:
+        // leave as identity
+        break;
+    }
+}
+
+void matrixMultiplyN(const float *m, EdgeList *list) {
+    int verts = list->vertexCount;
+    int dim = list->dimension;
+
+    float temp[MAX_DIMENSION];
+
+    for (int i = 0; i < verts; ++i) {
+        float *points = list->data + i;
+        int stride = list->stride;
+
+        for (int k = 0; k < dim; ++k) {
+            float sum = 0.0f;
+            for (int l = 0; l < dim; ++l) {
+                sum += m[k * dim + l] * points[l * stride];
+            }
+            temp[k] = sum;
+        }
+        for (int k = 0; k < dim; ++k) points[k * stride] = temp[k];
+    }
+}
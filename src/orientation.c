@@ -0,0 +1,163 @@
+#include <string.h>
+#include <math.h>
+
+#include <orientation.h>
+#include <math3d.h>
+
+// Renormalize after this many advances; one step's rounding is ~1 ulp
+#define RENORMALIZE_STEPS 16
+// Below this a per-frame step uses Taylor terms instead of sinf/cosf; the
+// truncation error is under 3e-9 there, well inside float precision
+#define SMALL_ANGLE 0.05f
+
+static void stepSinCos(float angle, float *s, float *c) {
+    if (fabsf(angle) < SMALL_ANGLE) {
+        float a2 = angle * angle;
+        *s = angle * (1.0f - a2 * (1.0f / 6.0f));
+        *c = 1.0f - a2 * 0.5f * (1.0f - a2 * (1.0f / 12.0f));
+    } else {
+        *s = sinf(angle);
+        *c = cosf(angle);
+    }
+}
+
+// out = a * b, components (w, x, y, z)
+static void quatMultiply(const float a[4], const float b[4], float out[4]) {
+    float w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    float x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    float y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    float z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    out[0] = w; out[1] = x; out[2] = y; out[3] = z;
+}
+
+static void quatNormalize(float q[4]) {
+    float n = 1.0f / sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int i = 0; i < 4; i++) q[i] *= n;
+}
+
+// Unit quaternion for angle about imaginary axis (1 = i, 2 = j, 3 = k)
+static void quatAxis(int axis, float angle, float out[4]) {
+    float s, c;
+    stepSinCos(angle * 0.5f, &s, &c);
+    out[0] = c; out[1] = out[2] = out[3] = 0.0f;
+    out[axis] = s;
+}
+
+// 3D plane (a, b) turns e_a toward e_b, i.e. about +/- the remaining axis,
+// positive when (a, b, k) is an even permutation of (0, 1, 2).
+static void advance3D(Orientation *o, int a, int b, float angle) {
+    if (angle == 0.0f) return;
+    int k = 3 - a - b;
+    int even = (a == 0 && b == 1) || (a == 1 && b == 2);
+    float d[4];
+    quatAxis(k + 1, even ? angle : -angle, d);
+    quatMultiply(d, o->q, o->q);
+}
+
+// 4D plane (a, b) as an isoclinic pair. With X, Y, Z, W as 1, i, j, k, left
+// and right multiplication by a unit imaginary u both turn the plane
+// {1, u} and its complement; the right one turns the complement backwards.
+// So the pair (u, u) isolates the plane containing X and (u, -u) the other.
+static void advance4D(Orientation *o, int a, int b, float angle) {
+    if (angle == 0.0f) return;
+    int axis;
+    float rightSign = 1.0f;
+    if (a == 0) {
+        axis = b; // XY -> i, XZ -> j, XW -> k
+    } else {
+        // ZW complements XY (i), YW complements XZ (j) and YZ complements
+        // XW (k); left multiplication by j turns YW backwards
+        axis = 6 - a - b;
+        rightSign = -1.0f;
+        if (a == 1 && b == 3) angle = -angle;
+    }
+    float dl[4], dr[4];
+    quatAxis(axis, angle, dl);
+    quatAxis(axis, rightSign * angle, dr);
+    quatMultiply(dl, o->left, o->left);
+    quatMultiply(o->right, dr, o->right);
+}
+
+static void advanceN(Orientation *o, int a, int b, float angle) {
+    if (angle == 0.0f) return;
+    int dim = o->dimension;
+    float s, c;
+    stepSinCos(angle, &s, &c);
+    float *rowA = o->matrix + a * dim;
+    float *rowB = o->matrix + b * dim;
+    for (int col = 0; col < dim; col++) {
+        float ra = rowA[col], rb = rowB[col];
+        rowA[col] = c * ra - s * rb;
+        rowB[col] = s * ra + c * rb;
+    }
+}
+
+// Modified Gram-Schmidt over the rows
+static void orthonormalize(float *m, int dim) {
+    for (int r = 0; r < dim; r++) {
+        float *row = m + r * dim;
+        for (int p = 0; p < r; p++) {
+            const float *prev = m + p * dim;
+            float dot = 0.0f;
+            for (int c = 0; c < dim; c++) dot += row[c] * prev[c];
+            for (int c = 0; c < dim; c++) row[c] -= dot * prev[c];
+        }
+        float len = 0.0f;
+        for (int c = 0; c < dim; c++) len += row[c] * row[c];
+        len = 1.0f / sqrtf(len);
+        for (int c = 0; c < dim; c++) row[c] *= len;
+    }
+}
+
+void orientationReset(Orientation *o, int dim) {
+    memset(o, 0, sizeof(*o));
+    o->dimension = dim;
+    o->q[0] = o->left[0] = o->right[0] = 1.0f;
+    matrixIdentityN(o->matrix, dim);
+}
+
+void orientationAdvance(Orientation *o, const AngleList *delta) {
+    int dim = o->dimension;
+    if (dim == 3) {
+        advance3D(o, 0, 2, -delta->plane[1]); // Visual X rotation
+        advance3D(o, 1, 2, delta->plane[2]);  // Visual Y rotation
+        advance3D(o, 0, 1, delta->plane[0]);  // Visual Z rotation
+    } else {
+        int plane = 0;
+        for (int a = 0; a < dim; a++)
+            for (int b = a + 1; b < dim; b++, plane++)
+                if (dim == 4) advance4D(o, a, b, delta->plane[plane]);
+                else advanceN(o, a, b, delta->plane[plane]);
+    }
+
+    if (++o->steps < RENORMALIZE_STEPS) return;
+    o->steps = 0;
+    if (dim == 3) quatNormalize(o->q);
+    else if (dim == 4) {
+        quatNormalize(o->left);
+        quatNormalize(o->right);
+    } else orthonormalize(o->matrix, dim);
+}
+
+void orientationMatrix(const Orientation *o, float *matrix) {
+    int dim = o->dimension;
+    if (dim == 3) {
+        float w = o->q[0], x = o->q[1], y = o->q[2], z = o->q[3];
+        matrix[0] = 1 - 2 * (y * y + z * z); matrix[1] = 2 * (x * y - w * z);     matrix[2] = 2 * (x * z + w * y);
+        matrix[3] = 2 * (x * y + w * z);     matrix[4] = 1 - 2 * (x * x + z * z); matrix[5] = 2 * (y * z - w * x);
+        matrix[6] = 2 * (x * z - w * y);     matrix[7] = 2 * (y * z + w * x);     matrix[8] = 1 - 2 * (x * x + y * y);
+    } else if (dim == 4) {
+        // p -> left * p * right is the product of the left- and
+        // right-multiplication matrices
+        float a = o->left[0], b = o->left[1], c = o->left[2], d = o->left[3];
+        float w = o->right[0], x = o->right[1], y = o->right[2], z = o->right[3];
+        float l[16] = { a, -b, -c, -d,  b, a, -d, c,  c, d, a, -b,  d, -c, b, a };
+        float r[16] = { w, -x, -y, -z,  x, w, z, -y,  y, -z, w, x,  z, y, -x, w };
+        for (int row = 0; row < 4; row++)
+            for (int col = 0; col < 4; col++)
+                matrix[row * 4 + col] = l[row * 4 + 0] * r[0 + col] + l[row * 4 + 1] * r[4 + col] +
+                                        l[row * 4 + 2] * r[8 + col] + l[row * 4 + 3] * r[12 + col];
+    } else {
+        memcpy(matrix, o->matrix, dim * dim * sizeof(float));
+    }
+}
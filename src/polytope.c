@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <polytope.h>
+#include <math3d.h>
+
+// Vertex rows start on this boundary, as allocVertexData guarantees
+#define POLYTOPE_ALIGN 64
+
+_Static_assert(sizeof(PolytopeHeader) == POLYTOPE_ALIGN, "header must keep the vertex rows aligned");
+
+#ifdef _WIN32
+
+static void *mapFile(const char *path, size_t *size) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER length;
+    void *base = NULL;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            // The view keeps the mapping alive once both handles are closed
+            base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        *size = (size_t)length.QuadPart;
+    }
+    CloseHandle(file);
+    return base;
+}
+
+static void unmapFile(void *base, size_t size) {
+    (void)size;
+    UnmapViewOfFile(base);
+}
+
+#else
+
+static void *mapFile(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void *base = NULL;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) base = NULL;
+        *size = (size_t)st.st_size;
+    }
+    close(fd);
+    return base;
+}
+
+static void unmapFile(void *base, size_t size) {
+    munmap(base, size);
+}
+
+#endif
+
+// The name is echoed verbatim into reports, so it stays printable and
+// free of characters that would need quoting
+static int nameIsPlain(const char *name, size_t length) {
+    for (size_t i = 0; i < length && name[i]; i++)
+        if (name[i] < 0x20 || name[i] > 0x7e || name[i] == '"' || name[i] == '\\') return 0;
+    return 1;
+}
+
+static const char *checkHeader(const PolytopeHeader *h, size_t size) {
+    if (size < sizeof(*h) || memcmp(h->magic, POLYTOPE_MAGIC, sizeof(h->magic)) != 0) return "not a polytope file";
+    if (h->version != POLYTOPE_VERSION) return "unsupported version";
+    if (!nameIsPlain(h->name, sizeof(h->name))) return "bad mesh name";
+    if (h->dimension < 3 || h->dimension > MAX_DIMENSION) return "dimension out of range";
+    if (h->vertexCount < 2 || h->vertexCount > (1u << 30)) return "bad vertex count";
+    if (h->stride != (uint32_t)vertexStrideFor((int)h->vertexCount)) return "bad stride";
+    if (h->dataOffset % POLYTOPE_ALIGN) return "misaligned vertex data";
+
+    uint64_t dataBytes = (uint64_t)h->dimension * h->stride * sizeof(float);
+    uint64_t edgeBytes = (uint64_t)h->edgeCount * 2 * sizeof(int32_t);
+    if (h->dataOffset < sizeof(*h) || h->dataOffset > size || dataBytes > size - h->dataOffset) return "truncated vertex data";
+    if (h->edgesOffset % sizeof(int32_t) || h->edgesOffset < h->dataOffset + dataBytes ||
+        h->edgesOffset > size || edgeBytes > size - h->edgesOffset || h->edgeCount > (1u << 29))
+        return "truncated edge data";
+    return NULL;
+}
+
+int polytopeOpen(Polytope *poly, const char *path) {
+    memset(poly, 0, sizeof(*poly));
+    size_t size = 0;
+    void *base = mapFile(path, &size);
+    if (!base) {
+        fprintf(stderr, "Failed to map %s\n", path);
+        return 0;
+    }
+
+    const PolytopeHeader *h = base;
+    const char *problem = checkHeader(h, size);
+    int *edges = problem ? NULL : (int *)((char *)base + h->edgesOffset);
+    // The one pass over the file: an index past the vertices would turn into
+    // out-of-bounds reads in every later stage
+    for (uint32_t e = 0; !problem && e < h->edgeCount * 2; e++)
+        if (edges[e] < 0 || (uint32_t)edges[e] >= h->vertexCount) problem = "edge index out of range";
+    if (problem) {
+        fprintf(stderr, "%s: %s\n", path, problem);
+        unmapFile(base, size);
+        return 0;
+    }
+
+    poly->header = h;
+    poly->base = base;
+    poly->size = size;
+    poly->mesh = (EdgeList){ (int)h->vertexCount, (int)h->edgeCount, (int)h->dimension, (int)h->stride,
+                             (float *)((char *)base + h->dataOffset), edges };
+    return 1;
+}
+
+void polytopeClose(Polytope *poly) {
+    if (poly->base) unmapFile(poly->base, poly->size);
+    memset(poly, 0, sizeof(*poly));
+}
+
+int polytopeWrite(const EdgeList *mesh, const char *name, const char *path) {
+    int stride = vertexStrideFor(mesh->vertexCount);
+    PolytopeHeader h = {0};
+    memcpy(h.magic, POLYTOPE_MAGIC, sizeof(h.magic));
+    h.version = POLYTOPE_VERSION;
+    h.dimension = (uint32_t)mesh->dimension;
+    h.vertexCount = (uint32_t)mesh->vertexCount;
+    h.edgeCount = (uint32_t)mesh->edgeCount;
+    h.stride = (uint32_t)stride;
+    h.dataOffset = sizeof(h);
+    h.edgesOffset = h.dataOffset + (uint64_t)mesh->dimension * stride * sizeof(float);
+    strncpy(h.name, name, sizeof(h.name) - 1);
+
+    FILE *file = fopen(path, "wb");
+    if (!file) return 0;
+    float *row = calloc(stride, sizeof(float));
+    int ok = row && fwrite(&h, sizeof(h), 1, file) == 1;
+    for (int d = 0; ok && d < mesh->dimension; d++) {
+        memcpy(row, mesh->data + (size_t)d * mesh->stride, mesh->vertexCount * sizeof(float));
+        ok = fwrite(row, sizeof(float), stride, file) == (size_t)stride;
+    }
+    ok = ok && fwrite(mesh->edges, sizeof(int), (size_t)mesh->edgeCount * 2, file) == (size_t)mesh->edgeCount * 2;
+    free(row);
+    if (fclose(file) != 0) ok = 0;
+    return ok;
+}
@@ -0,0 +1,175 @@
+#include <string.h>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <projection.h>
+
+// Vertices per block in the chained hyper projection; sized so the running
+// scale factors stay in L1.
+#define HYPER_BLOCK 256
+
+Proj projectOrthoN(const float *pt, int dimension, float screenW, float screenH, float scaleFactor) {
+    float x = (dimension > 0 ? pt[0] : 0.0f);
+    float y = (dimension > 1 ? pt[1] : 0.0f);
+
+    return (Proj){ x * screenW  * scaleFactor + (screenW  * 0.5f), y * screenH  * scaleFactor + (screenH  * 0.5f) };
+}
+
+Proj projectPerspective3D(float x, float y, float z, float screenW, float screenH, float camDistance, float fovY) {
+    float aspectRatio = screenW / screenH;
+    float fovY_radius = fovY * M_PI / 180.0f;
+    float f = 1.0f / tan(fovY_radius / 2.0f);
+    float zCameraOffset = z + camDistance;
+    if (zCameraOffset < 0.01f) zCameraOffset = 0.01f;
+
+    float xNormalizedDeviceCoords = (x * f / aspectRatio) / zCameraOffset;
+    float yNormalizedDeviceCoords = (y * f) / zCameraOffset;
+
+    float screenX = (xNormalizedDeviceCoords * 0.5f + 0.5f) * screenW;
+    float screenY = (1.0f - (yNormalizedDeviceCoords * 0.5f + 0.5f)) * screenH; 
+
+    return (Proj){screenX, screenY};
+}
+
+void projectHyper4Dto3D(const float *pt4, int dim, float screenW, float screenH, float cam4DDistance, float fov4D, Proj *out, float cameraDistance, float fovY) {
+    projectHyperNto3D(pt4, 4, screenW, screenH, cam4DDistance, fov4D, out, cameraDistance, fovY);
+}
+
+// Chained perspective: divide away the last axis one dimension at a time
+// until three remain, then hand off to the 3D camera.
+void projectHyperNto3D(const float *pt, int dim, float screenW, float screenH, float camNDistance, float fovN, Proj *out, float cameraDistance, float fovY) {
+    float fN = 1.0f / tanf(fovN * (M_PI/180.0f) * 0.5f);
+    float p[MAX_DIMENSION];
+    memcpy(p, pt, dim * sizeof(float));
+
+    for (int d = dim - 1; d >= 3; d--) {
+        float offset = camNDistance + p[d];
+        if (offset < 0.01f) offset = 0.01f;
+        for (int k = 0; k < d; k++) p[k] = (p[k] * fN) / offset;
+    }
+    p[0] /= (float)screenW / screenH;
+    *out = projectPerspective3D(p[0], p[1], p[2], screenW, screenH, cameraDistance, fovY);
+}
+
+void flatten4Dto3D(const float *pt4, float out3[3]) {
+    out3[0] = pt4[0];
+    out3[1] = pt4[1];
+    out3[2] = pt4[2] + pt4[3];
+}
+
+void flattenNto3D(const float *pt, int dim, float out3[3]) {
+    out3[0] = pt[0];
+    out3[1] = pt[1];
+    out3[2] = pt[2];
+    for (int d = 3; d < dim; d++) out3[2] += pt[d];
+}
+
+void cameraUpdate(Camera *cam, float screenW, float screenH, float scaleFactor, float cameraDistance, float fovY, float hyperCamDistance, float hyperFov) {
+    float aspectRatio = screenW / screenH;
+    cam->screenW = screenW;
+    cam->screenH = screenH;
+    cam->halfW = screenW * 0.5f;
+    cam->halfH = screenH * 0.5f;
+    cam->orthoScaleX = screenW * scaleFactor;
+    cam->orthoScaleY = screenH * scaleFactor;
+    cam->f = 1.0f / tanf(fovY * (float)M_PI / 180.0f * 0.5f);
+    cam->fOverAspect = cam->f / aspectRatio;
+    cam->cameraDistance = cameraDistance;
+    cam->hyperF = 1.0f / tanf(hyperFov * (float)M_PI / 180.0f * 0.5f);
+    cam->hyperDistance = hyperCamDistance;
+    cam->invAspect = 1.0f / aspectRatio;
+}
+
+void projectOrthoBatch(const Camera *cam, const EdgeList *verts, Proj *out) {
+    const float *xs = verts->data;
+    const float *ys = verts->data + verts->stride;
+    float sx = cam->orthoScaleX, sy = cam->orthoScaleY, halfW = cam->halfW, halfH = cam->halfH;
+    for (int i = 0; i < verts->vertexCount; i++) {
+        out[i].x = xs[i] * sx + halfW;
+        out[i].y = ys[i] * sy + halfH;
+    }
+}
+
+// Near clamp as a plain select; fmaxf's NaN rules keep it from vectorizing
+static inline float clampNear(float z) {
+    return z > CAMERA_NEAR ? z : CAMERA_NEAR;
+}
+
+void projectPerspectiveBatch(const Camera *cam, const EdgeList *verts, Proj *out) {
+    const float *xs = verts->data;
+    const float *ys = verts->data + verts->stride;
+    const float *zs = verts->data + 2 * verts->stride;
+    float fx = cam->fOverAspect * cam->halfW, fy = cam->f * cam->halfH;
+    float halfW = cam->halfW, halfH = cam->halfH, distance = cam->cameraDistance;
+    for (int i = 0; i < verts->vertexCount; i++) {
+        float invZ = 1.0f / clampNear(zs[i] + distance);
+        out[i].x = halfW + xs[i] * fx * invZ;
+        out[i].y = halfH - ys[i] * fy * invZ;
+    }
+}
+
+void projectHyperBatch(const Camera *cam, const EdgeList *verts, Proj *out) {
+    int dim = verts->dimension, stride = verts->stride;
+    const float *xs = verts->data;
+    const float *ys = verts->data + stride;
+    const float *zs = verts->data + 2 * stride;
+    float fx = cam->fOverAspect * cam->invAspect * cam->halfW, fy = cam->f * cam->halfH;
+    float halfW = cam->halfW, halfH = cam->halfH, distance = cam->cameraDistance;
+    float hyperF = cam->hyperF, hyperDistance = cam->hyperDistance;
+    float scale[HYPER_BLOCK];
+
+    // Each chained divide only rescales the lower axes, so a vertex's
+    // projection is its rest coordinates times one accumulated factor.
+    for (int base = 0; base < verts->vertexCount; base += HYPER_BLOCK) {
+        int count = verts->vertexCount - base;
+        if (count > HYPER_BLOCK) count = HYPER_BLOCK;
+
+        for (int i = 0; i < count; i++) scale[i] = 1.0f;
+        for (int d = dim - 1; d >= 3; d--) {
+            const float *ws = verts->data + d * stride + base;
+            for (int i = 0; i < count; i++)
+                scale[i] *= hyperF / clampNear(hyperDistance + ws[i] * scale[i]);
+        }
+
+        const float *bx = xs + base, *by = ys + base, *bz = zs + base;
+        Proj *bout = out + base;
+        for (int i = 0; i < count; i++) {
+            float invZ = scale[i] / clampNear(bz[i] * scale[i] + distance);
+            bout[i].x = halfW + bx[i] * fx * invZ;
+            bout[i].y = halfH - by[i] * fy * invZ;
+        }
+    }
+}
+
+void collapseHyperBatch(const Camera *cam, const EdgeList *verts, float *out3) {
+    int dim = verts->dimension, stride = verts->stride;
+    float hyperF = cam->hyperF, hyperDistance = cam->hyperDistance;
+    float scale[HYPER_BLOCK];
+
+    for (int base = 0; base < verts->vertexCount; base += HYPER_BLOCK) {
+        int count = verts->vertexCount - base;
+        if (count > HYPER_BLOCK) count = HYPER_BLOCK;
+
+        for (int i = 0; i < count; i++) scale[i] = 1.0f;
+        for (int d = dim - 1; d >= 3; d--) {
+            const float *ws = verts->data + d * stride + base;
+            for (int i = 0; i < count; i++)
+                scale[i] *= hyperF / clampNear(hyperDistance + ws[i] * scale[i]);
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            const float *in = verts->data + axis * stride + base;
+            float *out = out3 + axis * stride + base;
+            for (int i = 0; i < count; i++) out[i] = in[i] * scale[i];
+        }
+    }
+}
+
+void flattenBatch(const EdgeList *verts, float *out3) {
+    int stride = verts->stride;
+    memcpy(out3, verts->data, 3 * stride * sizeof(float));
+    for (int d = 3; d < verts->dimension; d++) {
+        const float *ws = verts->data + d * stride;
+        for (int i = 0; i < stride; i++) out3[2 * stride + i] += ws[i];
+    }
+}
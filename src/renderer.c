@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <renderer.h>
+#include <threadpool.h>
+
+#define TILE_SIZE 64
+
+struct SoftwareRenderer {
+    Framebuffer fb;
+    int tilesX, tilesY;
+    int *tileCounts;
+    int *tileOffsets; // tileCount + 1 entries, prefix sums of tileCounts
+    int *tileEdges;
+    int tileEdgeCapacity;
+    ThreadPool *pool;
+
+    // Parameters of the draw in flight, read by the tile tasks
+    const Proj *verts;
+    const int *edges;
+    float extent; // half thickness plus the half-pixel AA ramp
+    uint32_t color;
+    uint32_t background;
+};
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static float segmentDistance(float px, float py, Proj a, Proj b) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float len2 = dx * dx + dy * dy;
+    float t = len2 > 1e-12f ? clampf(((px - a.x) * dx + (py - a.y) * dy) / len2, 0.0f, 1.0f) : 0.0f;
+    float ex = px - (a.x + t * dx), ey = py - (a.y + t * dy);
+    return sqrtf(ex * ex + ey * ey);
+}
+
+// Tile range covered by the edge's padded bounding box; 0 when it misses
+// the screen or has non-finite endpoints.
+static int edgeTileBounds(const SoftwareRenderer *r, Proj a, Proj b, int *tx0, int *ty0, int *tx1, int *ty1) {
+    if (!isfinite(a.x) || !isfinite(a.y) || !isfinite(b.x) || !isfinite(b.y)) return 0;
+    float e = r->extent;
+    float minX = fminf(a.x, b.x) - e, maxX = fmaxf(a.x, b.x) + e;
+    float minY = fminf(a.y, b.y) - e, maxY = fmaxf(a.y, b.y) + e;
+    if (maxX < 0 || maxY < 0 || minX >= r->fb.width || minY >= r->fb.height) return 0;
+
+    *tx0 = (int)clampf(minX, 0, r->fb.width - 1) / TILE_SIZE;
+    *tx1 = (int)clampf(maxX, 0, r->fb.width - 1) / TILE_SIZE;
+    *ty0 = (int)clampf(minY, 0, r->fb.height - 1) / TILE_SIZE;
+    *ty1 = (int)clampf(maxY, 0, r->fb.height - 1) / TILE_SIZE;
+    return 1;
+}
+
+// Conservative: the tile's circumscribed circle overlaps the edge capsule
+static int edgeTouchesTile(const SoftwareRenderer *r, Proj a, Proj b, int tx, int ty) {
+    float half = TILE_SIZE * 0.5f;
+    float cx = tx * TILE_SIZE + half, cy = ty * TILE_SIZE + half;
+    return segmentDistance(cx, cy, a, b) <= r->extent + half * 1.4142136f;
+}
+
+static int binEdges(SoftwareRenderer *r, int edgeCount) {
+    int tileCount = r->tilesX * r->tilesY;
+    memset(r->tileCounts, 0, tileCount * sizeof(int));
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            r->tileOffsets[0] = 0;
+            for (int t = 0; t < tileCount; t++) r->tileOffsets[t + 1] = r->tileOffsets[t] + r->tileCounts[t];
+            int total = r->tileOffsets[tileCount];
+            if (total > r->tileEdgeCapacity) {
+                int *grown = realloc(r->tileEdges, total * sizeof(int));
+                if (!grown) return -1;
+                r->tileEdges = grown;
+                r->tileEdgeCapacity = total;
+            }
+            memset(r->tileCounts, 0, tileCount * sizeof(int));
+        }
+
+        for (int e = 0; e < edgeCount; e++) {
+            Proj a = r->verts[r->edges[e * 2 + 0]];
+            Proj b = r->verts[r->edges[e * 2 + 1]];
+            int tx0, ty0, tx1, ty1;
+            if (!edgeTileBounds(r, a, b, &tx0, &ty0, &tx1, &ty1)) continue;
+
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) {
+                    if (!edgeTouchesTile(r, a, b, tx, ty)) continue;
+                    int tile = ty * r->tilesX + tx;
+                    if (pass == 1) r->tileEdges[r->tileOffsets[tile] + r->tileCounts[tile]] = e;
+                    r->tileCounts[tile]++;
+                }
+            }
+        }
+    }
+    return r->tileOffsets[tileCount];
+}
+
+static uint32_t blend(uint32_t dst, uint32_t src, float coverage) {
+    int c = (int)(coverage * 255.0f + 0.5f);
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        int d = (dst >> shift) & 0xFF, s = (src >> shift) & 0xFF;
+        out |= (uint32_t)(d + ((s - d) * c + 127) / 255) << shift;
+    }
+    return out;
+}
+
+// Capsule-distance coverage, walking only the span of each row that lies
+// inside the line's band
+static void drawEdgeInTile(SoftwareRenderer *r, Proj a, Proj b, int x0, int y0, int x1, int y1) {
+    float e = r->extent;
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float len = sqrtf(dx * dx + dy * dy);
+    uint32_t *pixels = r->fb.pixels;
+    int width = r->fb.width;
+
+    int rowStart = (int)clampf(floorf(fminf(a.y, b.y) - e), (float)y0, (float)y1);
+    int rowEnd = (int)clampf(ceilf(fmaxf(a.y, b.y) + e), (float)y0, (float)y1);
+    for (int y = rowStart; y < rowEnd; y++) {
+        float py = y + 0.5f;
+        float spanStart = fminf(a.x, b.x) - e, spanEnd = fmaxf(a.x, b.x) + e;
+        if (fabsf(dy) > 1e-6f) {
+            float centre = a.x + dx * (py - a.y) / dy;
+            float halfWidth = e * len / fabsf(dy);
+            spanStart = fmaxf(spanStart, centre - halfWidth);
+            spanEnd = fminf(spanEnd, centre + halfWidth);
+        }
+        int xs = (int)clampf(floorf(spanStart), (float)x0, (float)x1);
+        int xe = (int)clampf(ceilf(spanEnd), (float)x0, (float)x1);
+
+        uint32_t *row = pixels + (size_t)y * width;
+        for (int x = xs; x < xe; x++) {
+            float coverage = clampf(e - segmentDistance(x + 0.5f, py, a, b), 0.0f, 1.0f);
+            if (coverage > 0.0f) row[x] = blend(row[x], r->color, coverage);
+        }
+    }
+}
+
+static void rasterTile(void *ctx, int tile) {
+    SoftwareRenderer *r = ctx;
+    int tx = tile % r->tilesX, ty = tile / r->tilesX;
+    int x0 = tx * TILE_SIZE, y0 = ty * TILE_SIZE;
+    int x1 = x0 + TILE_SIZE < r->fb.width ? x0 + TILE_SIZE : r->fb.width;
+    int y1 = y0 + TILE_SIZE < r->fb.height ? y0 + TILE_SIZE : r->fb.height;
+
+    for (int y = y0; y < y1; y++) {
+        uint32_t *row = r->fb.pixels + (size_t)y * r->fb.width;
+        for (int x = x0; x < x1; x++) row[x] = r->background;
+    }
+
+    const int *bin = r->tileEdges + r->tileOffsets[tile];
+    for (int i = 0; i < r->tileCounts[tile]; i++) {
+        int e = bin[i];
+        drawEdgeInTile(r, r->verts[r->edges[e * 2 + 0]], r->verts[r->edges[e * 2 + 1]], x0, y0, x1, y1);
+    }
+}
+
+SoftwareRenderer *softwareRendererCreate(int width, int height, int threads) {
+    SoftwareRenderer *r = calloc(1, sizeof(SoftwareRenderer));
+    if (!r) return NULL;
+    r->pool = threadPoolCreate(threads);
+    if (!r->pool || !softwareRendererResize(r, width, height)) {
+        softwareRendererDestroy(r);
+        return NULL;
+    }
+    return r;
+}
+
+void softwareRendererDestroy(SoftwareRenderer *r) {
+    if (!r) return;
+    threadPoolDestroy(r->pool);
+    free(r->fb.pixels);
+    free(r->tileCounts);
+    free(r->tileOffsets);
+    free(r->tileEdges);
+    free(r);
+}
+
+int softwareRendererResize(SoftwareRenderer *r, int width, int height) {
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    if (r->fb.pixels && r->fb.width == width && r->fb.height == height) return 1;
+
+    int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE, tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    uint32_t *pixels = malloc((size_t)width * height * sizeof(uint32_t));
+    int *counts = malloc(tilesX * tilesY * sizeof(int));
+    int *offsets = malloc((tilesX * tilesY + 1) * sizeof(int));
+    if (!pixels || !counts || !offsets) {
+        free(pixels);
+        free(counts);
+        free(offsets);
+        return 0;
+    }
+
+    free(r->fb.pixels);
+    free(r->tileCounts);
+    free(r->tileOffsets);
+    r->fb = (Framebuffer){ width, height, pixels };
+    r->tilesX = tilesX;
+    r->tilesY = tilesY;
+    r->tileCounts = counts;
+    r->tileOffsets = offsets;
+    return 1;
+}
+
+int softwareRendererDraw(SoftwareRenderer *r, const Proj *verts, const int *edges, int edgeCount,
+                         float thickness, uint32_t color, uint32_t background) {
+    r->verts = verts;
+    r->edges = edges;
+    r->extent = thickness * 0.5f + 0.5f;
+    r->color = color;
+    r->background = background;
+
+    int binned = binEdges(r, edgeCount);
+    if (binned < 0) return -1;
+    threadPoolRun(r->pool, rasterTile, r, r->tilesX * r->tilesY);
+    return binned;
+}
+
+const Framebuffer *softwareRendererFramebuffer(const SoftwareRenderer *r) {
+    return &r->fb;
+}
+
+int framebufferWritePPM(const Framebuffer *fb, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return 0;
+
+    fprintf(file, "P6\n%d %d\n255\n", fb->width, fb->height);
+    unsigned char *row = malloc((size_t)fb->width * 3);
+    int ok = row != NULL;
+    for (int y = 0; ok && y < fb->height; y++) {
+        const uint32_t *src = fb->pixels + (size_t)y * fb->width;
+        for (int x = 0; x < fb->width; x++) {
+            row[x * 3 + 0] = src[x] & 0xFF;
+            row[x * 3 + 1] = (src[x] >> 8) & 0xFF;
+            row[x * 3 + 2] = (src[x] >> 16) & 0xFF;
+        }
+        ok = fwrite(row, 3, fb->width, file) == (size_t)fb->width;
+    }
+    free(row);
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,446 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <simulation.h>
+#include <triplebuffer.h>
+#include <thread.h>
+#include <threadpool.h>
+#include <instances.h>
+#include <cube3d.h>
+#include <math3d.h>
+#include <frame.h>
+#include <clip.h>
+#include <slice.h>
+#include <lod.h>
+#include <orientation.h>
+#include <timer.h>
+#include <trace.h>
+
+struct Simulation {
+    const Polytope *meshes;
+    double period;
+    void (*wake)(void);
+    Thread thread;
+    atomic_int quit;
+
+    // Inputs flow main -> simulation, snapshots simulation -> main. The
+    // mutex only guards the idle wait for a new input.
+    SimulationInput inputs[3];
+    TripleBuffer inputBuffer;
+    atomic_uint inputSequence;
+    Mutex mutex;
+    CondVar inputChanged;
+    SimulationSnapshot snapshots[3];
+    TripleBuffer snapshotBuffer;
+
+    // Simulation thread only
+    int dimension;
+    int slicing;
+    EdgeList rest, pose;
+    float *poseStorage; // sized for the largest cube up front, reused by every pose
+    int poseCapacity;
+    Orientation orientation;
+    int instanceRequest;
+    InstanceSet scene;
+    ThreadPool *pool;
+    // Face tables for cross-sections, built the first time a dimension is sliced
+    Slicer slicers[MAX_DIMENSION + 1];
+    unsigned char slicerFailed[MAX_DIMENSION + 1];
+    EdgeLod lod;
+    unsigned char *clipCodes; // outcodes of the mesh being clipped
+    int clipCodeCapacity;
+    unsigned generation;
+    int droppedTicks;
+
+    // Render thread only: the vertices of the snapshot before the current
+    // one, and the blend of the two
+    Proj *previous;
+    int previousCapacity, previousCount;
+    unsigned previousGeneration;
+    double previousTime;
+    Proj *blended;
+    int blendedCapacity;
+};
+
+// The mapped mesh for dim when one was given, otherwise the n-cube table
+static EdgeList restPose(const Polytope *meshes, int dim) {
+    return meshes[dim].base ? meshes[dim].mesh : *cubeMesh(dim);
+}
+
+int simulationInputEqual(const SimulationInput *a, const SimulationInput *b) {
+    const ViewState *v = &a->view, *w = &b->view;
+    return a->dimension == b->dimension && a->instanceCount == b->instanceCount &&
+           !memcmp(a->rotate, b->rotate, sizeof(a->rotate)) && a->radiansPerSecond == b->radiansPerSecond &&
+           v->projectionType == w->projectionType && v->scaleFactor == w->scaleFactor &&
+           v->cameraDistance == w->cameraDistance && v->fovY == w->fovY &&
+           v->hyperCamDistance == w->hyperCamDistance && v->hyperFov == w->hyperFov &&
+           v->width == w->width && v->height == w->height &&
+           v->slice == w->slice && v->sliceOffset == w->sliceOffset && v->lod == w->lod;
+}
+
+// Rebuilds the mesh and instance scene when the input asks for a different
+// one. Every rebuild starts a new generation.
+static void applyInput(Simulation *sim, const SimulationInput *input) {
+    int dimensionChanged = input->dimension != sim->dimension;
+    if (dimensionChanged) {
+        // Both poses are looked up or reused, so switching allocates nothing
+        // unless a mapped mesh outgrows the pose storage
+        sim->dimension = input->dimension;
+        sim->rest = restPose(sim->meshes, sim->dimension);
+        int floats = sim->rest.dimension * sim->rest.stride;
+        if (floats > sim->poseCapacity) {
+            freeVertexData(sim->poseStorage);
+            sim->poseStorage = allocVertexData(sim->rest.dimension, sim->rest.stride);
+            sim->poseCapacity = sim->poseStorage ? floats : 0;
+        }
+        sim->pose = sim->rest;
+        sim->pose.data = sim->poseStorage;
+        if (!sim->rest.data || !sim->pose.data) printf("Pose memory allocation failed for %d dimensions\n", sim->dimension);
+        orientationReset(&sim->orientation, sim->dimension);
+        sim->generation++;
+    }
+
+    // Slice vertices index mesh edges rather than vertices
+    int slicing = input->view.slice && sim->dimension >= 4;
+    if (slicing != sim->slicing) {
+        sim->slicing = slicing;
+        sim->generation++;
+    }
+
+    // The instance scene mixes dimensions 3..dimension
+    if (input->instanceCount != sim->instanceRequest || (input->instanceCount && dimensionChanged)) {
+        instanceSetFree(&sim->scene);
+        if (input->instanceCount && !sim->pool) sim->pool = threadPoolCreate(0);
+        if (input->instanceCount && (!sim->pool || !instanceSetCreate(&sim->scene, input->instanceCount, 3, sim->dimension, 1)))
+            printf("Instance allocation failed for %d instances\n", input->instanceCount);
+        sim->instanceRequest = input->instanceCount;
+        sim->generation++;
+    }
+}
+
+static int anyRotation(const SimulationInput *input) {
+    for (int p = 0; p < planeCount(input->dimension); p++)
+        if (input->rotate[p]) return 1;
+    return 0;
+}
+
+// Snapshot buffers are replaced rather than grown since their contents are
+// rewritten every tick
+static int reserveSnapshot(SimulationSnapshot *snap, int projected, int edges) {
+    if (snap->projectedCapacity < projected) {
+        free(snap->projected);
+        snap->projected = malloc((size_t)projected * sizeof(Proj));
+        snap->projectedCapacity = snap->projected ? projected : 0;
+    }
+    if (snap->edgeCapacity < edges) {
+        free(snap->edges);
+        snap->edges = malloc((size_t)edges * 2 * sizeof(int));
+        snap->edgeCapacity = snap->edges ? edges : 0;
+    }
+    return snap->projectedCapacity >= projected && snap->edgeCapacity >= edges;
+}
+
+// The slicer for the current mesh, or NULL when it cannot be cut
+static Slicer *currentSlicer(Simulation *sim) {
+    Slicer *s = &sim->slicers[sim->dimension];
+    if (!s->faces && !sim->slicerFailed[sim->dimension] && !slicerCreate(s, &sim->rest)) {
+        printf("The %dD mesh cannot be sliced (it needs n-cube connectivity)\n", sim->dimension);
+        sim->slicerFailed[sim->dimension] = 1;
+    }
+    return s->faces ? s : NULL;
+}
+
+// Projects the current geometry into snap and fills in its counts
+static void projectInto(Simulation *sim, SimulationSnapshot *snap, const SimulationInput *input) {
+    const ViewState *v = &input->view;
+    Camera camera;
+    cameraUpdate(&camera, (float)v->width, (float)v->height, v->scaleFactor, v->cameraDistance, v->fovY, v->hyperCamDistance, v->hyperFov);
+    snap->vertexCount = snap->edgeCount = snap->totalEdgeCount = 0;
+    snap->clippedEdges = snap->culledEdges = 0;
+    snap->sliced = 0;
+    snap->lodMerged = snap->lodDegenerate = 0;
+
+    InstanceSet *scene = &sim->scene;
+    if (scene->count) {
+        // The scene projects into its own buffers, which are then swapped
+        // with the snapshot's, so publishing never copies vertices. The
+        // arrays handed to the scene must hold a whole projection.
+        int projected = scene->vertexCount + scene->totalEdgeCount * 2;
+        if (!reserveSnapshot(snap, projected, scene->totalEdgeCount)) return;
+        instanceSetProject(scene, sim->pool, &camera, v->projectionType);
+        Proj *p = scene->projected;
+        int *e = scene->edges;
+        scene->projected = snap->projected;
+        scene->edges = snap->edges;
+        snap->projected = p;
+        snap->edges = e;
+        snap->projectedCapacity = projected;
+        snap->edgeCapacity = scene->totalEdgeCount;
+        snap->vertexCount = scene->vertexCount;
+        snap->edgeCount = scene->edgeCount;
+        snap->totalEdgeCount = scene->totalEdgeCount;
+        snap->clippedEdges = scene->clippedEdges;
+        snap->culledEdges = scene->culledEdges;
+    } else if (sim->pose.data) {
+        // A cross-section is cut first and then projected like any mesh,
+        // with room for as many edges as the mesh has faces
+        const EdgeList *pose = &sim->pose;
+        int edgeRoom = pose->edgeCount;
+        Slicer *slicer = sim->slicing ? currentSlicer(sim) : NULL;
+        if (slicer) {
+            slicerCut(slicer, pose, v->sliceOffset);
+            pose = &slicer->slice;
+            edgeRoom = slicer->faceCount;
+            snap->sliced = 1;
+        }
+        // Room for the endpoints clipping creates after the projected vertices
+        if (!reserveSnapshot(snap, pose->vertexCount + edgeRoom * 2, edgeRoom)) return;
+        if (sim->clipCodeCapacity < pose->vertexCount) {
+            free(sim->clipCodes);
+            sim->clipCodes = malloc(pose->vertexCount);
+            sim->clipCodeCapacity = sim->clipCodes ? pose->vertexCount : 0;
+        }
+        frameProject(&camera, v->projectionType, pose, snap->projected);
+        ClipStats clip = clipEdges(&camera, v->projectionType, pose, NULL, snap->projected, 0,
+                                   snap->projected + pose->vertexCount, pose->vertexCount, snap->edges, sim->clipCodes);
+        snap->vertexCount = pose->vertexCount;
+        snap->edgeCount = clip.visible;
+        snap->totalEdgeCount = pose->edgeCount;
+        snap->clippedEdges = clip.clipped;
+        snap->culledEdges = clip.culled;
+    }
+
+    // Whatever survived clipping is reduced to distinct screen segments
+    if (v->lod && snap->edgeCount) {
+        LodStats lod = edgeLodReduce(&sim->lod, snap->projected, snap->vertexCount, snap->edges, snap->edgeCount,
+                                     EDGE_LOD_CELL, snap->edges);
+        snap->edgeCount = lod.drawn;
+        snap->lodMerged = lod.merged;
+        snap->lodDegenerate = lod.degenerate;
+    }
+}
+
+// Blocks until an input newer than sequence arrives or the simulation quits
+static void waitForInput(Simulation *sim, unsigned sequence) {
+    mutexLock(&sim->mutex);
+    while (!atomic_load(&sim->quit) && atomic_load(&sim->inputSequence) == sequence)
+        condWait(&sim->inputChanged, &sim->mutex);
+    mutexUnlock(&sim->mutex);
+}
+
+static void simulationMain(void *arg) {
+    Simulation *sim = arg;
+    traceSetThreadName("simulation");
+    SimulationInput input = {0};
+    int dirty = 0, wasAnimating = 0;
+    double next = timerNow(), stateTime = next;
+
+    while (!atomic_load(&sim->quit)) {
+        if (tripleBufferAcquire(&sim->inputBuffer)) {
+            input = sim->inputs[tripleBufferFront(&sim->inputBuffer)];
+            applyInput(sim, &input);
+            dirty = 1;
+        }
+        if (!input.sequence) {
+            waitForInput(sim, 0);
+            continue;
+        }
+
+        int animating = sim->scene.count > 0 || anyRotation(&input);
+        double now = timerNow();
+        if (!animating && !dirty) {
+            wasAnimating = 0;
+            waitForInput(sim, input.sequence);
+            continue;
+        }
+        if (animating && !wasAnimating) next = stateTime = now;
+        wasAnimating = animating;
+        // A changed input is shown right away; otherwise wait for the tick,
+        // which bounds the input latency to one period
+        if (!dirty && now < next) {
+            threadSleepMicros((int)((next - now) * 1e6) + 1);
+            continue;
+        }
+
+        // Every tick due since the last one, in whole periods. A stall longer
+        // than the catch-up limit slows the animation down rather than
+        // making every later tick late too.
+        int steps = 0;
+        float lateMs = 0.0f;
+        if (animating && now >= next) {
+            lateMs = (float)((now - next) * 1e3);
+            while (next <= now) {
+                next += sim->period;
+                steps++;
+            }
+            if (steps > SIMULATION_MAX_CATCHUP) {
+                sim->droppedTicks += steps - SIMULATION_MAX_CATCHUP;
+                steps = SIMULATION_MAX_CATCHUP;
+            }
+        }
+        float dt = (float)(steps * sim->period);
+
+        TraceZone tick = traceBegin("tick");
+        double tickStart = timerNow();
+        TraceZone zone = traceBegin("transform");
+        double time = next - sim->period;
+        if (sim->scene.count) {
+            // Instances transform from their angles and then advance them, so
+            // the result is the state the last tick left
+            instanceSetTransform(&sim->scene, sim->pool, dt);
+            time = stateTime;
+        } else if (sim->pose.data) {
+            frameAdvance(&sim->orientation, input.rotate, dt, input.radiansPerSecond);
+            float rotation[MAX_DIMENSION * MAX_DIMENSION];
+            orientationMatrix(&sim->orientation, rotation);
+            transformVerticesN(rotation, &sim->rest, &sim->pose);
+        }
+        if (animating) stateTime = next - sim->period;
+        else stateTime = time = now;
+        traceEnd(&zone);
+
+        zone = traceBegin("project");
+        SimulationSnapshot *snap = &sim->snapshots[tripleBufferBack(&sim->snapshotBuffer)];
+        projectInto(sim, snap, &input);
+        traceEnd(&zone);
+
+        snap->dimension = sim->dimension;
+        snap->instanceCount = sim->scene.count;
+        snap->generation = sim->generation;
+        snap->animating = animating;
+        snap->time = time;
+        snap->inputSequence = input.sequence;
+        snap->tickMs = (float)((timerNow() - tickStart) * 1e3);
+        snap->lateMs = lateMs;
+        snap->droppedTicks = sim->droppedTicks;
+        tripleBufferPublish(&sim->snapshotBuffer);
+        traceEnd(&tick);
+        if (sim->wake) sim->wake();
+        dirty = 0;
+    }
+}
+
+Simulation *simulationCreate(const Polytope *meshes, double tickRate, void (*wake)(void)) {
+    Simulation *sim = calloc(1, sizeof(Simulation));
+    if (!sim) return NULL;
+    sim->meshes = meshes;
+    sim->period = 1.0 / (tickRate > 0.0 ? tickRate : SIMULATION_DEFAULT_TICK_RATE);
+    sim->wake = wake;
+    const EdgeList *largest = cubeMesh(MAX_DIMENSION);
+    sim->poseStorage = allocVertexData(largest->dimension, largest->stride);
+    sim->poseCapacity = sim->poseStorage ? largest->dimension * largest->stride : 0;
+    tripleBufferInit(&sim->inputBuffer);
+    tripleBufferInit(&sim->snapshotBuffer);
+    atomic_init(&sim->quit, 0);
+    atomic_init(&sim->inputSequence, 0);
+    mutexInit(&sim->mutex);
+    condInit(&sim->inputChanged);
+    if (threadCreate(&sim->thread, simulationMain, sim) != 0) {
+        mutexDestroy(&sim->mutex);
+        condDestroy(&sim->inputChanged);
+        freeVertexData(sim->poseStorage);
+        free(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+void simulationDestroy(Simulation *sim) {
+    if (!sim) return;
+    mutexLock(&sim->mutex);
+    atomic_store(&sim->quit, 1);
+    condSignal(&sim->inputChanged);
+    mutexUnlock(&sim->mutex);
+    threadJoin(sim->thread);
+
+    instanceSetFree(&sim->scene);
+    threadPoolDestroy(sim->pool);
+    freeVertexData(sim->poseStorage);
+    for (int d = 0; d <= MAX_DIMENSION; d++) slicerFree(&sim->slicers[d]);
+    edgeLodFree(&sim->lod);
+    free(sim->clipCodes);
+    for (int i = 0; i < 3; i++) {
+        free(sim->snapshots[i].projected);
+        free(sim->snapshots[i].edges);
+    }
+    free(sim->previous);
+    free(sim->blended);
+    mutexDestroy(&sim->mutex);
+    condDestroy(&sim->inputChanged);
+    free(sim);
+}
+
+double simulationTickPeriod(const Simulation *sim) {
+    return sim->period;
+}
+
+unsigned simulationSetInput(Simulation *sim, const SimulationInput *input) {
+    unsigned sequence = atomic_load(&sim->inputSequence) + 1;
+    SimulationInput *slot = &sim->inputs[tripleBufferBack(&sim->inputBuffer)];
+    *slot = *input;
+    slot->sequence = sequence;
+    tripleBufferPublish(&sim->inputBuffer);
+
+    // Only an idle simulation waits on this
+    mutexLock(&sim->mutex);
+    atomic_store(&sim->inputSequence, sequence);
+    condSignal(&sim->inputChanged);
+    mutexUnlock(&sim->mutex);
+    return sequence;
+}
+
+int simulationAcquire(Simulation *sim) {
+    if (!tripleBufferPending(&sim->snapshotBuffer)) return 0;
+    // The front slot goes back to the simulation on acquire, so its
+    // vertices are kept first
+    const SimulationSnapshot *old = simulationCurrent(sim);
+    if (old->vertexCount > sim->previousCapacity) {
+        free(sim->previous);
+        sim->previous = malloc((size_t)old->vertexCount * sizeof(Proj));
+        sim->previousCapacity = sim->previous ? old->vertexCount : 0;
+    }
+    sim->previousCount = old->vertexCount <= sim->previousCapacity ? old->vertexCount : 0;
+    if (sim->previousCount) memcpy(sim->previous, old->projected, (size_t)sim->previousCount * sizeof(Proj));
+    sim->previousGeneration = old->generation;
+    sim->previousTime = old->time;
+    tripleBufferAcquire(&sim->snapshotBuffer);
+
+    // Clipped endpoints are not blended; they only change with a new
+    // snapshot, so they are copied into the blend once here
+    const SimulationSnapshot *cur = simulationCurrent(sim);
+    if (cur->clippedEdges && cur->projectedCapacity <= sim->blendedCapacity)
+        for (int i = 0; i < cur->edgeCount * 2; i++)
+            if (cur->edges[i] >= cur->vertexCount) sim->blended[cur->edges[i]] = cur->projected[cur->edges[i]];
+    return 1;
+}
+
+const SimulationSnapshot *simulationCurrent(Simulation *sim) {
+    return &sim->snapshots[tripleBufferFront(&sim->snapshotBuffer)];
+}
+
+const Proj *simulationInterpolate(Simulation *sim, double renderTime) {
+    const SimulationSnapshot *cur = simulationCurrent(sim);
+    if (!cur->animating || cur->generation != sim->previousGeneration || cur->vertexCount != sim->previousCount ||
+        cur->time <= sim->previousTime || renderTime >= cur->time)
+        return cur->projected;
+
+    if (cur->projectedCapacity > sim->blendedCapacity) {
+        free(sim->blended);
+        sim->blended = malloc((size_t)cur->projectedCapacity * sizeof(Proj));
+        sim->blendedCapacity = sim->blended ? cur->projectedCapacity : 0;
+        if (!sim->blended) return cur->projected;
+        for (int i = 0; i < cur->edgeCount * 2; i++)
+            if (cur->edges[i] >= cur->vertexCount) sim->blended[cur->edges[i]] = cur->projected[cur->edges[i]];
+    }
+
+    float t = (float)((renderTime - sim->previousTime) / (cur->time - sim->previousTime));
+    if (t < 0.0f) t = 0.0f;
+    const Proj *a = sim->previous, *b = cur->projected;
+    for (int i = 0; i < cur->vertexCount; i++) {
+        sim->blended[i].x = a[i].x + (b[i].x - a[i].x) * t;
+        sim->blended[i].y = a[i].y + (b[i].y - a[i].y) * t;
+    }
+    return sim->blended;
+}
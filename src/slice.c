@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <slice.h>
+#include <math3d.h>
+
+// For each mask of crossing edges in a square face, the two that form its
+// slice edge. A plane meets a parallelogram's boundary at most twice, so
+// every other mask yields nothing.
+static const signed char pairFirst[16]  = { -1, -1, -1, 0, -1, 0, 1, -1, -1, 0, 1, -1, 2, -1, -1, -1 };
+static const signed char pairSecond[16] = { -1, -1, -1, 1, -1, 2, 2, -1, -1, 3, 3, -1, 3, -1, -1, -1 };
+
+int slicerCreate(Slicer *s, const EdgeList *mesh) {
+    memset(s, 0, sizeof(*s));
+    int dim = mesh->dimension;
+    if (dim < 4 || dim > MAX_DIMENSION || mesh->vertexCount != 1 << dim || mesh->edgeCount != dim << (dim - 1))
+        return 0;
+
+    // Each edge is found by its lower vertex and the axis it runs along
+    int *edgeAt = malloc((size_t)mesh->vertexCount * dim * sizeof(int));
+    if (!edgeAt) return 0;
+    for (int i = 0; i < mesh->vertexCount * dim; i++) edgeAt[i] = -1;
+    int valid = 1;
+    for (int e = 0; e < mesh->edgeCount && valid; e++) {
+        int a = mesh->edges[e * 2], b = mesh->edges[e * 2 + 1];
+        int diff = a ^ b, low = a < b ? a : b;
+        valid = a >= 0 && b >= 0 && a < mesh->vertexCount && b < mesh->vertexCount && diff && !(diff & (diff - 1));
+        int axis = 0;
+        while (valid && !(diff >> axis & 1)) axis++;
+        if (valid) edgeAt[low * dim + axis] = e;
+    }
+
+    s->dimension = dim;
+    s->edgeCount = mesh->edgeCount;
+    s->faceCount = dim * (dim - 1) / 2 * (1 << (dim - 2));
+    s->from = malloc(mesh->edgeCount * sizeof(int));
+    s->to = malloc(mesh->edgeCount * sizeof(int));
+    s->faces = malloc((size_t)s->faceCount * 4 * sizeof(int));
+    s->t = malloc(mesh->edgeCount * sizeof(float));
+    s->ends = malloc((size_t)mesh->edgeCount * 2 * sizeof(float));
+    s->crossing = malloc(mesh->edgeCount);
+    s->slice.dimension = dim - 1;
+    s->slice.vertexCount = mesh->edgeCount;
+    s->slice.stride = vertexStrideFor(mesh->edgeCount);
+    s->slice.data = allocVertexData(dim - 1, s->slice.stride);
+    s->slice.edges = malloc((size_t)s->faceCount * 2 * sizeof(int));
+    if (!valid || !s->from || !s->to || !s->faces || !s->t || !s->ends || !s->crossing || !s->slice.data || !s->slice.edges) {
+        free(edgeAt);
+        slicerFree(s);
+        return 0;
+    }
+
+    for (int e = 0; e < mesh->edgeCount; e++) {
+        s->from[e] = mesh->edges[e * 2];
+        s->to[e] = mesh->edges[e * 2 + 1];
+    }
+    // Square (v, a, b) spans axes a < b from a vertex with both bits clear
+    int f = 0;
+    for (int v = 0; v < mesh->vertexCount && valid; v++)
+        for (int a = 0; a < dim; a++)
+            for (int b = a + 1; b < dim; b++) {
+                if (v & ((1 << a) | (1 << b))) continue;
+                int *face = s->faces + f++ * 4;
+                face[0] = edgeAt[v * dim + a];
+                face[1] = edgeAt[v * dim + b];
+                face[2] = edgeAt[(v | 1 << a) * dim + b];
+                face[3] = edgeAt[(v | 1 << b) * dim + a];
+                valid = face[0] >= 0 && face[1] >= 0 && face[2] >= 0 && face[3] >= 0;
+            }
+    free(edgeAt);
+    if (!valid) {
+        slicerFree(s);
+        return 0;
+    }
+    return 1;
+}
+
+void slicerFree(Slicer *s) {
+    free(s->from);
+    free(s->to);
+    free(s->faces);
+    free(s->t);
+    free(s->ends);
+    free(s->crossing);
+    freeVertexData(s->slice.data);
+    free(s->slice.edges);
+    memset(s, 0, sizeof(*s));
+}
+
+// Copies both endpoint values of every edge on one axis into contiguous
+// planes, so the passes over them run at unit stride
+static void gatherEnds(const float *restrict axis, const int *restrict from, const int *restrict to,
+                       float *restrict a, float *restrict b, int n) {
+    for (int e = 0; e < n; e++) {
+        a[e] = axis[from[e]];
+        b[e] = axis[to[e]];
+    }
+}
+
+int slicerCut(Slicer *s, const EdgeList *pose, float offset) {
+    int n = s->edgeCount, dim = s->dimension, stride = pose->stride, out = s->slice.stride;
+    float *restrict t = s->t;
+    float *restrict a = s->ends, *restrict b = s->ends + n;
+    unsigned char *restrict crossing = s->crossing;
+
+    // Where every edge meets the hyperplane, clamped onto the edge. The
+    // division runs unconditionally and a zero span is replaced afterwards,
+    // so the pass is all selects (max, min, blend) and vectorizes.
+    gatherEnds(pose->data + (dim - 1) * stride, s->from, s->to, a, b, n);
+    for (int e = 0; e < n; e++) {
+        float wa = a[e] - offset, wb = b[e] - offset;
+        float span = wa - wb;
+        float at = wa / span;
+        at = at > 0.0f ? at : 0.0f;
+        at = at < 1.0f ? at : 1.0f;
+        t[e] = span == 0.0f ? 0.0f : at;
+        crossing[e] = (wa >= 0.0f) != (wb >= 0.0f);
+    }
+    for (int d = 0; d < dim - 1; d++) {
+        float *restrict q = s->slice.data + d * out;
+        gatherEnds(pose->data + d * stride, s->from, s->to, a, b, n);
+        for (int e = 0; e < n; e++) q[e] = a[e] + (b[e] - a[e]) * t[e];
+    }
+
+    // Each face the hyperplane crosses contributes one edge
+    int *edges = s->slice.edges, count = 0;
+    for (int f = 0; f < s->faceCount; f++) {
+        const int *face = s->faces + f * 4;
+        int mask = crossing[face[0]] | crossing[face[1]] << 1 | crossing[face[2]] << 2 | crossing[face[3]] << 3;
+        if (pairFirst[mask] < 0) continue;
+        edges[count * 2] = face[pairFirst[mask]];
+        edges[count * 2 + 1] = face[pairSecond[mask]];
+        count++;
+    }
+    s->slice.edgeCount = count;
+    return count;
+}
@@ -0,0 +1,111 @@
+#include <stdlib.h>
+
+#include <thread.h>
+#include <trace.h>
+
+typedef struct {
+    ThreadFn fn;
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+
+static DWORD WINAPI threadTrampoline(LPVOID param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.fn(start.arg);
+    traceThreadExit();
+    return 0;
+}
+
+int threadCreate(Thread *thread, ThreadFn fn, void *arg) {
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+    *thread = CreateThread(NULL, 0, threadTrampoline, start, 0, NULL);
+    if (!*thread) {
+        free(start);
+        return -1;
+    }
+    return 0;
+}
+
+void threadJoin(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void threadYield(void) { SwitchToThread(); }
+
+// Sleep has millisecond granularity, so short waits round up to 1ms
+void threadSleepMicros(int micros) { Sleep((DWORD)((micros + 999) / 1000)); }
+
+int hardwareThreadCount(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+void mutexInit(Mutex *mutex) { InitializeSRWLock(mutex); }
+void mutexDestroy(Mutex *mutex) { (void)mutex; }
+void mutexLock(Mutex *mutex) { AcquireSRWLockExclusive(mutex); }
+void mutexUnlock(Mutex *mutex) { ReleaseSRWLockExclusive(mutex); }
+
+void condInit(CondVar *cond) { InitializeConditionVariable(cond); }
+void condDestroy(CondVar *cond) { (void)cond; }
+void condWait(CondVar *cond, Mutex *mutex) { SleepConditionVariableSRW(cond, mutex, INFINITE, 0); }
+void condSignal(CondVar *cond) { WakeConditionVariable(cond); }
+void condBroadcast(CondVar *cond) { WakeAllConditionVariable(cond); }
+
+#else
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+static void *threadTrampoline(void *param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.fn(start.arg);
+    traceThreadExit();
+    return NULL;
+}
+
+int threadCreate(Thread *thread, ThreadFn fn, void *arg) {
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, threadTrampoline, start) != 0) {
+        free(start);
+        return -1;
+    }
+    return 0;
+}
+
+void threadJoin(Thread thread) { pthread_join(thread, NULL); }
+
+void threadYield(void) { sched_yield(); }
+
+void threadSleepMicros(int micros) {
+    struct timespec ts = { micros / 1000000, (long)(micros % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+int hardwareThreadCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+void mutexInit(Mutex *mutex) { pthread_mutex_init(mutex, NULL); }
+void mutexDestroy(Mutex *mutex) { pthread_mutex_destroy(mutex); }
+void mutexLock(Mutex *mutex) { pthread_mutex_lock(mutex); }
+void mutexUnlock(Mutex *mutex) { pthread_mutex_unlock(mutex); }
+
+void condInit(CondVar *cond) { pthread_cond_init(cond, NULL); }
+void condDestroy(CondVar *cond) { pthread_cond_destroy(cond); }
+void condWait(CondVar *cond, Mutex *mutex) { pthread_cond_wait(cond, mutex); }
+void condSignal(CondVar *cond) { pthread_cond_signal(cond); }
+void condBroadcast(CondVar *cond) { pthread_cond_broadcast(cond); }
+
+#endif
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include <threadpool.h>
+#include <thread.h>
+#include <trace.h>
+
+// A thread's remaining [begin, end) work range packed into one word, so the
+// owner taking from the front and thieves splitting off the back each need
+// only a single CAS. Padded to keep owners off each other's cache lines.
+typedef struct {
+    _Atomic uint64_t range;
+    char pad[64 - sizeof(uint64_t)];
+} WorkRange;
+
+typedef struct {
+    struct ThreadPool *pool;
+    int index;
+} WorkerStart;
+
+struct ThreadPool {
+    Thread *workers;
+    WorkerStart *starts;
+    int workerCount;
+
+    Mutex lock;
+    CondVar wake;
+    CondVar done;
+    int generation; // bumped for every job
+    int active;     // workers still inside the current job
+    int quit;
+
+    ThreadTask task;
+    void *ctx;
+    int count;
+    atomic_int next;
+
+    // Work-stealing jobs only; one range per thread, the caller's last
+    int stealing;
+    int grain;
+    WorkRange *ranges;
+};
+
+static uint64_t packRange(uint32_t begin, uint32_t end) {
+    return (uint64_t)begin | ((uint64_t)end << 32);
+}
+
+// Owner side: claim up to grain indices from the front of its own range
+static int takeFront(WorkRange *own, int grain, int *begin, int *end) {
+    uint64_t r = atomic_load_explicit(&own->range, memory_order_acquire);
+    for (;;) {
+        uint32_t b = (uint32_t)r, e = (uint32_t)(r >> 32);
+        if (b >= e) return 0;
+        uint32_t nb = e - b > (uint32_t)grain ? b + grain : e;
+        if (atomic_compare_exchange_weak_explicit(&own->range, &r, packRange(nb, e), memory_order_acq_rel, memory_order_acquire)) {
+            *begin = (int)b;
+            *end = (int)nb;
+            return 1;
+        }
+    }
+}
+
+// Thief side: split the back half off victim's range and make it our own.
+// Our range is empty here, so no other thread can be modifying it.
+static int stealBack(WorkRange *victim, WorkRange *own) {
+    uint64_t r = atomic_load_explicit(&victim->range, memory_order_acquire);
+    for (;;) {
+        uint32_t b = (uint32_t)r, e = (uint32_t)(r >> 32);
+        if (b >= e) return 0;
+        uint32_t mid = e - (e - b + 1) / 2;
+        if (atomic_compare_exchange_weak_explicit(&victim->range, &r, packRange(b, mid), memory_order_acq_rel, memory_order_acquire)) {
+            atomic_store_explicit(&own->range, packRange(mid, e), memory_order_release);
+            return 1;
+        }
+    }
+}
+
+static void runStealing(ThreadPool *pool, int self) {
+    int threads = pool->workerCount + 1;
+    WorkRange *own = &pool->ranges[self];
+    for (;;) {
+        int begin, end;
+        while (takeFront(own, pool->grain, &begin, &end))
+            for (int i = begin; i < end; i++) pool->task(pool->ctx, i);
+
+        int stolen = 0;
+        for (int k = 1; k < threads && !stolen; k++) stolen = stealBack(&pool->ranges[(self + k) % threads], own);
+        if (!stolen) return;
+    }
+}
+
+static void runTasks(ThreadPool *pool, int self) {
+    if (pool->stealing) {
+        runStealing(pool, self);
+        return;
+    }
+    int i;
+    while ((i = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed)) < pool->count)
+        pool->task(pool->ctx, i);
+}
+
+static void workerMain(void *arg) {
+    WorkerStart *start = arg;
+    ThreadPool *pool = start->pool;
+    int seen = 0;
+    char name[32];
+    snprintf(name, sizeof(name), "pool worker %d", start->index);
+    traceSetThreadName(name);
+
+    mutexLock(&pool->lock);
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) condWait(&pool->wake, &pool->lock);
+        if (pool->quit) break;
+        seen = pool->generation;
+        mutexUnlock(&pool->lock);
+
+        TraceZone zone = traceBegin("pool job");
+        runTasks(pool, start->index);
+        traceEnd(&zone);
+
+        mutexLock(&pool->lock);
+        if (--pool->active == 0) condSignal(&pool->done);
+    }
+    mutexUnlock(&pool->lock);
+}
+
+ThreadPool *threadPoolCreate(int threads) {
+    if (threads <= 0) threads = hardwareThreadCount();
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+    pool->workers = calloc(threads, sizeof(Thread));
+    pool->starts = calloc(threads, sizeof(WorkerStart));
+    pool->ranges = calloc(threads, sizeof(WorkRange));
+    if (!pool->workers || !pool->starts || !pool->ranges) {
+        free(pool->workers);
+        free(pool->starts);
+        free(pool->ranges);
+        free(pool);
+        return NULL;
+    }
+    mutexInit(&pool->lock);
+    condInit(&pool->wake);
+    condInit(&pool->done);
+    atomic_init(&pool->next, 0);
+    for (int i = 0; i < threads; i++) atomic_init(&pool->ranges[i].range, 0);
+
+    for (int i = 0; i < threads - 1; i++) {
+        pool->starts[i] = (WorkerStart){ pool, i };
+        if (threadCreate(&pool->workers[i], workerMain, &pool->starts[i]) != 0) break;
+        pool->workerCount++;
+    }
+    return pool;
+}
+
+void threadPoolDestroy(ThreadPool *pool) {
+    if (!pool) return;
+    mutexLock(&pool->lock);
+    pool->quit = 1;
+    condBroadcast(&pool->wake);
+    mutexUnlock(&pool->lock);
+
+    for (int i = 0; i < pool->workerCount; i++) threadJoin(pool->workers[i]);
+    condDestroy(&pool->wake);
+    condDestroy(&pool->done);
+    mutexDestroy(&pool->lock);
+    free(pool->workers);
+    free(pool->starts);
+    free(pool->ranges);
+    free(pool);
+}
+
+int threadPoolSize(const ThreadPool *pool) {
+    return pool->workerCount + 1;
+}
+
+static void runJob(ThreadPool *pool) {
+    mutexLock(&pool->lock);
+    pool->active = pool->workerCount;
+    pool->generation++;
+    condBroadcast(&pool->wake);
+    mutexUnlock(&pool->lock);
+
+    runTasks(pool, pool->workerCount);
+
+    mutexLock(&pool->lock);
+    while (pool->active > 0) condWait(&pool->done, &pool->lock);
+    mutexUnlock(&pool->lock);
+}
+
+void threadPoolRun(ThreadPool *pool, ThreadTask task, void *ctx, int count) {
+    if (pool->workerCount == 0 || count <= 1) {
+        for (int i = 0; i < count; i++) task(ctx, i);
+        return;
+    }
+
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->stealing = 0;
+    atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+    runJob(pool);
+}
+
+void threadPoolRunStealing(ThreadPool *pool, ThreadTask task, void *ctx, int count, int grain) {
+    if (pool->workerCount == 0 || count <= 1) {
+        for (int i = 0; i < count; i++) task(ctx, i);
+        return;
+    }
+
+    int threads = pool->workerCount + 1;
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->stealing = 1;
+    pool->grain = grain > 0 ? grain : 1;
+    for (int t = 0; t < threads; t++) {
+        uint32_t begin = (uint32_t)((int64_t)count * t / threads);
+        uint32_t end = (uint32_t)((int64_t)count * (t + 1) / threads);
+        atomic_store_explicit(&pool->ranges[t].range, packRange(begin, end), memory_order_relaxed);
+    }
+    runJob(pool);
+}
@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <trace.h>
+#include <timer.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+static inline uint64_t traceClock(void) { return __rdtsc(); }
+#else
+static inline uint64_t traceClock(void) { return (uint64_t)(timerNow() * 1e9); }
+#endif
+
+#ifdef _MSC_VER
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+#define TRACE_NAME_LENGTH 32
+
+typedef struct {
+    const char *name;
+    uint64_t start, end;
+} TraceEvent;
+
+// A ring slot, read by traceWriteChrome while its thread may be rewriting it
+typedef struct {
+    _Atomic(const char *) name;
+    _Atomic uint64_t start, end;
+} TraceSlot;
+
+// A thread's stretch of a ring: the events counted from first until the
+// next owner took over
+typedef struct {
+    uint64_t first;
+    int id;
+    char name[TRACE_NAME_LENGTH];
+} TraceOwner;
+
+// Past owners remembered per ring; the oldest is forgotten beyond this
+#define TRACE_OWNERS 8
+
+// Events are written only by the ring's current thread, and count is
+// published with release after each one. A ring outlives its thread and is
+// handed to the next thread that records, which carries on counting, so
+// there are only ever as many rings as threads recording at once. Each
+// owner's zones keep their own tid and name in the written trace.
+typedef struct TraceBuffer {
+    TraceSlot events[TRACE_EVENTS_PER_THREAD];
+    _Atomic uint64_t count;
+    int inUse;                    // guarded by registryLock, as are the owners
+    int ownerCount;
+    TraceOwner owners[TRACE_OWNERS]; // oldest first, the last is the current thread
+    struct TraceBuffer *next;     // fixed once the ring is on the list
+} TraceBuffer;
+
+static atomic_int enabled;
+static _Atomic(TraceBuffer *) buffers;
+static atomic_int threadCount;
+// Held only to hand rings out and to copy names, never while recording
+static atomic_flag registryLock = ATOMIC_FLAG_INIT;
+static uint64_t epochTicks;
+static double epochSeconds;
+
+static TRACE_THREAD_LOCAL TraceBuffer *localBuffer;
+static TRACE_THREAD_LOCAL char localName[TRACE_NAME_LENGTH];
+
+void traceSetEnabled(int on) {
+    // The first enable fixes the time origin for every thread
+    if (on && !epochTicks) {
+        epochSeconds = timerNow();
+        epochTicks = traceClock();
+    }
+    atomic_store_explicit(&enabled, on, memory_order_relaxed);
+}
+
+int traceEnabled(void) {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+TraceZone traceBegin(const char *name) {
+    TraceZone zone = { name, 0 };
+    if (atomic_load_explicit(&enabled, memory_order_relaxed)) zone.start = traceClock();
+    return zone;
+}
+
+static void lockRegistry(void) {
+    while (atomic_flag_test_and_set_explicit(&registryLock, memory_order_acquire)) continue;
+}
+
+static void unlockRegistry(void) {
+    atomic_flag_clear_explicit(&registryLock, memory_order_release);
+}
+
+// A thread takes a ring with its first recorded zone: one left by a thread
+// that has exited if there is one, otherwise a new one. Rings are never
+// freed, so stages that have finished can still be written out.
+static TraceBuffer *threadBuffer(void) {
+    if (localBuffer) return localBuffer;
+    lockRegistry();
+    TraceBuffer *buffer = atomic_load_explicit(&buffers, memory_order_relaxed);
+    while (buffer && buffer->inUse) buffer = buffer->next;
+    if (!buffer) {
+        buffer = calloc(1, sizeof(TraceBuffer));
+        if (!buffer) {
+            unlockRegistry();
+            return NULL;
+        }
+        buffer->next = atomic_load_explicit(&buffers, memory_order_relaxed);
+        atomic_store_explicit(&buffers, buffer, memory_order_release);
+    }
+    buffer->inUse = 1;
+    if (buffer->ownerCount == TRACE_OWNERS) {
+        memmove(buffer->owners, buffer->owners + 1, (TRACE_OWNERS - 1) * sizeof(TraceOwner));
+        buffer->ownerCount--;
+    }
+    TraceOwner *owner = &buffer->owners[buffer->ownerCount++];
+    owner->first = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    owner->id = atomic_fetch_add(&threadCount, 1) + 1;
+    if (localName[0]) memcpy(owner->name, localName, TRACE_NAME_LENGTH);
+    else snprintf(owner->name, TRACE_NAME_LENGTH, "thread %d", owner->id);
+    unlockRegistry();
+    localBuffer = buffer;
+    return buffer;
+}
+
+void traceEnd(const TraceZone *zone) {
+    if (!zone->start) return;
+    uint64_t end = traceClock();
+    TraceBuffer *buffer = threadBuffer();
+    if (!buffer) return;
+    uint64_t n = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    TraceSlot *slot = &buffer->events[n & (TRACE_EVENTS_PER_THREAD - 1)];
+    // Orders the count before the slot's new contents, so a reader that
+    // sees any of them also sees the slot is being rewritten
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->name, zone->name, memory_order_relaxed);
+    atomic_store_explicit(&slot->start, zone->start, memory_order_relaxed);
+    atomic_store_explicit(&slot->end, end, memory_order_relaxed);
+    atomic_store_explicit(&buffer->count, n + 1, memory_order_release);
+}
+
+void traceSetThreadName(const char *name) {
+    snprintf(localName, TRACE_NAME_LENGTH, "%s", name);
+    if (!localBuffer) return;
+    lockRegistry();
+    memcpy(localBuffer->owners[localBuffer->ownerCount - 1].name, localName, TRACE_NAME_LENGTH);
+    unlockRegistry();
+}
+
+void traceThreadExit(void) {
+    if (!localBuffer) return;
+    lockRegistry();
+    localBuffer->inUse = 0;
+    unlockRegistry();
+    localBuffer = NULL;
+    localName[0] = 0;
+}
+
+// Cycle-counter ticks per microsecond, measured against the monotonic clock
+// since tracing was first enabled
+static double ticksPerMicrosecond(void) {
+    double seconds = timerNow() - epochSeconds;
+    uint64_t ticks = traceClock() - epochTicks;
+    while (seconds < 0.01) {
+        seconds = timerNow() - epochSeconds;
+        ticks = traceClock() - epochTicks;
+    }
+    return (double)ticks / (seconds * 1e6);
+}
+
+// Copies the ring's surviving events into events and returns the index of
+// the first one that is whole. Slots its thread began rewriting during the
+// copy may be torn, so they are left out.
+static uint64_t copyRing(TraceBuffer *buffer, TraceEvent *events, uint64_t *count) {
+    uint64_t n = atomic_load_explicit(&buffer->count, memory_order_acquire);
+    uint64_t first = n > TRACE_EVENTS_PER_THREAD ? n - TRACE_EVENTS_PER_THREAD : 0;
+    for (uint64_t i = first; i < n; i++) {
+        TraceSlot *slot = &buffer->events[i & (TRACE_EVENTS_PER_THREAD - 1)];
+        TraceEvent *event = &events[i & (TRACE_EVENTS_PER_THREAD - 1)];
+        event->name = atomic_load_explicit(&slot->name, memory_order_relaxed);
+        event->start = atomic_load_explicit(&slot->start, memory_order_relaxed);
+        event->end = atomic_load_explicit(&slot->end, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t now = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    if (now >= TRACE_EVENTS_PER_THREAD && now - TRACE_EVENTS_PER_THREAD + 1 > first)
+        first = now - TRACE_EVENTS_PER_THREAD + 1;
+    *count = n;
+    return first < n ? first : n;
+}
+
+int traceWriteChrome(const char *path) {
+    TraceEvent *events = malloc(TRACE_EVENTS_PER_THREAD * sizeof(TraceEvent));
+    if (!events) return 0;
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        free(events);
+        return 0;
+    }
+    double scale = 1.0 / ticksPerMicrosecond();
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    int first = 1;
+    for (TraceBuffer *buffer = atomic_load_explicit(&buffers, memory_order_acquire); buffer; buffer = buffer->next) {
+        // Owners are read after the events, so every owner of a copied
+        // event is among them
+        uint64_t n, i = copyRing(buffer, events, &n);
+        TraceOwner owners[TRACE_OWNERS];
+        lockRegistry();
+        int ownerCount = buffer->ownerCount;
+        memcpy(owners, buffer->owners, ownerCount * sizeof(TraceOwner));
+        unlockRegistry();
+
+        // Zones from before the oldest remembered owner have none
+        if (ownerCount && i < owners[0].first) i = owners[0].first < n ? owners[0].first : n;
+        for (int k = 0; k < ownerCount; k++) {
+            const TraceOwner *owner = &owners[k];
+            uint64_t end = k + 1 < ownerCount && owners[k + 1].first < n ? owners[k + 1].first : n;
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", owner->id, owner->name);
+            first = 0;
+            for (; i < end; i++) {
+                const TraceEvent *event = &events[i & (TRACE_EVENTS_PER_THREAD - 1)];
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        event->name, owner->id, (double)(int64_t)(event->start - epochTicks) * scale,
+                        (double)(event->end - event->start) * scale);
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    free(events);
+    return fclose(file) == 0;
+}
+
+void frameTimesAdd(FrameTimes *times, float ms) {
+    times->ms[times->next] = ms;
+    times->next = (times->next + 1) % TRACE_FRAME_HISTORY;
+    if (times->count < TRACE_FRAME_HISTORY) times->count++;
+}
+
+static int compareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+int frameTimesSorted(const FrameTimes *times, float *sorted) {
+    memcpy(sorted, times->ms, times->count * sizeof(float));
+    qsort(sorted, times->count, sizeof(float), compareFloat);
+    return times->count;
+}
@@ -0,0 +1,238 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <math3d.h>
+
+// Vertex transform kernels over SoA vertex data. Every axis plane is
+// VERTEX_STRIDE_MULTIPLE floats long at minimum and VERTEX_ALIGNMENT
+// aligned, so the kernels use aligned full-width loads and never need a
+// scalar tail loop; the padding lanes are transformed along with the rest.
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TRANSFORM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET(isa)
+#else
+#define TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+#define FIXED_DIM_MAX 5
+
+typedef void (*TransformKernel)(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim);
+
+int vertexStrideFor(int vertexCount) {
+    return (vertexCount + VERTEX_STRIDE_MULTIPLE - 1) / VERTEX_STRIDE_MULTIPLE * VERTEX_STRIDE_MULTIPLE;
+}
+
+float *allocVertexData(int dimension, int stride) {
+    size_t size = (size_t)dimension * stride * sizeof(float);
+    void *data;
+#ifdef _WIN32
+    data = _aligned_malloc(size, VERTEX_ALIGNMENT);
+#else
+    if (posix_memalign(&data, VERTEX_ALIGNMENT, size) != 0) data = NULL;
+#endif
+    if (data) memset(data, 0, size);
+    return data;
+}
+
+void freeVertexData(float *data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+// Scalar fallback, also used on non-x86 targets where the compiler is left
+// to auto-vectorize the inner loop.
+static void transformScalar(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) {
+    for (int k = 0; k < dim; k++) {
+        float *out = dst + k * stride;
+        for (int i = 0; i < stride; i++) out[i] = 0.0f;
+        for (int l = 0; l < dim; l++) {
+            const float *in = src + l * stride;
+            float coef = m[k * dim + l];
+            for (int i = 0; i < stride; i++) out[i] += coef * in[i];
+        }
+    }
+}
+
+#ifdef TRANSFORM_X86
+
+// Each ISA gets a fixed-dimension body (matrix broadcasts hoisted out of the
+// vertex loop, fully unrolled once dim is a constant) and a generic body that
+// re-broadcasts per vertex block so it works for any dimension.
+
+static inline void transformFixedSSE2(const float *restrict m, const float *restrict src, float *restrict dst, int stride, const int dim) {
+    __m128 mv[FIXED_DIM_MAX * FIXED_DIM_MAX];
+    for (int i = 0; i < dim * dim; i++) mv[i] = _mm_set1_ps(m[i]);
+    for (int i = 0; i < stride; i += 4) {
+        __m128 in[FIXED_DIM_MAX];
+        for (int l = 0; l < dim; l++) in[l] = _mm_load_ps(src + l * stride + i);
+        for (int k = 0; k < dim; k++) {
+            __m128 acc = _mm_mul_ps(mv[k * dim], in[0]);
+            for (int l = 1; l < dim; l++) acc = _mm_add_ps(acc, _mm_mul_ps(mv[k * dim + l], in[l]));
+            _mm_store_ps(dst + k * stride + i, acc);
+        }
+    }
+}
+
+static void transformSSE2_3(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedSSE2(m, src, dst, stride, 3); }
+static void transformSSE2_4(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedSSE2(m, src, dst, stride, 4); }
+static void transformSSE2_5(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedSSE2(m, src, dst, stride, 5); }
+
+static void transformSSE2_N(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) {
+    for (int i = 0; i < stride; i += 4) {
+        for (int k = 0; k < dim; k++) {
+            const float *row = m + k * dim;
+            __m128 acc = _mm_mul_ps(_mm_set1_ps(row[0]), _mm_load_ps(src + i));
+            for (int l = 1; l < dim; l++)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(row[l]), _mm_load_ps(src + l * stride + i)));
+            _mm_store_ps(dst + k * stride + i, acc);
+        }
+    }
+}
+
+TARGET("avx2,fma")
+static inline void transformFixedAVX2(const float *restrict m, const float *restrict src, float *restrict dst, int stride, const int dim) {
+    __m256 mv[FIXED_DIM_MAX * FIXED_DIM_MAX];
+    for (int i = 0; i < dim * dim; i++) mv[i] = _mm256_set1_ps(m[i]);
+    for (int i = 0; i < stride; i += 8) {
+        __m256 in[FIXED_DIM_MAX];
+        for (int l = 0; l < dim; l++) in[l] = _mm256_load_ps(src + l * stride + i);
+        for (int k = 0; k < dim; k++) {
+            __m256 acc = _mm256_mul_ps(mv[k * dim], in[0]);
+            for (int l = 1; l < dim; l++) acc = _mm256_fmadd_ps(mv[k * dim + l], in[l], acc);
+            _mm256_store_ps(dst + k * stride + i, acc);
+        }
+    }
+}
+
+TARGET("avx2,fma") static void transformAVX2_3(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedAVX2(m, src, dst, stride, 3); }
+TARGET("avx2,fma") static void transformAVX2_4(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedAVX2(m, src, dst, stride, 4); }
+TARGET("avx2,fma") static void transformAVX2_5(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedAVX2(m, src, dst, stride, 5); }
+
+TARGET("avx2,fma")
+static void transformAVX2_N(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) {
+    for (int i = 0; i < stride; i += 8) {
+        for (int k = 0; k < dim; k++) {
+            const float *row = m + k * dim;
+            __m256 acc = _mm256_mul_ps(_mm256_set1_ps(row[0]), _mm256_load_ps(src + i));
+            for (int l = 1; l < dim; l++)
+                acc = _mm256_fmadd_ps(_mm256_set1_ps(row[l]), _mm256_load_ps(src + l * stride + i), acc);
+            _mm256_store_ps(dst + k * stride + i, acc);
+        }
+    }
+}
+
+TARGET("avx512f")
+static inline void transformFixedAVX512(const float *restrict m, const float *restrict src, float *restrict dst, int stride, const int dim) {
+    __m512 mv[FIXED_DIM_MAX * FIXED_DIM_MAX];
+    for (int i = 0; i < dim * dim; i++) mv[i] = _mm512_set1_ps(m[i]);
+    for (int i = 0; i < stride; i += 16) {
+        __m512 in[FIXED_DIM_MAX];
+        for (int l = 0; l < dim; l++) in[l] = _mm512_load_ps(src + l * stride + i);
+        for (int k = 0; k < dim; k++) {
+            __m512 acc = _mm512_mul_ps(mv[k * dim], in[0]);
+            for (int l = 1; l < dim; l++) acc = _mm512_fmadd_ps(mv[k * dim + l], in[l], acc);
+            _mm512_store_ps(dst + k * stride + i, acc);
+        }
+    }
+}
+
+TARGET("avx512f") static void transformAVX512_3(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedAVX512(m, src, dst, stride, 3); }
+TARGET("avx512f") static void transformAVX512_4(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedAVX512(m, src, dst, stride, 4); }
+TARGET("avx512f") static void transformAVX512_5(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) { (void)dim; transformFixedAVX512(m, src, dst, stride, 5); }
+
+TARGET("avx512f")
+static void transformAVX512_N(const float *restrict m, const float *restrict src, float *restrict dst, int stride, int dim) {
+    for (int i = 0; i < stride; i += 16) {
+        for (int k = 0; k < dim; k++) {
+            const float *row = m + k * dim;
+            __m512 acc = _mm512_mul_ps(_mm512_set1_ps(row[0]), _mm512_load_ps(src + i));
+            for (int l = 1; l < dim; l++)
+                acc = _mm512_fmadd_ps(_mm512_set1_ps(row[l]), _mm512_load_ps(src + l * stride + i), acc);
+            _mm512_store_ps(dst + k * stride + i, acc);
+        }
+    }
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+static int cpuHasAVX2(void) {
+    int info[4];
+    __cpuid(info, 1);
+    int osxsave = (info[2] >> 27) & 1, fma = (info[2] >> 12) & 1;
+    if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6) return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+}
+
+static int cpuHasAVX512(void) {
+    int info[4];
+    if (!cpuHasAVX2() || (_xgetbv(0) & 0xE6) != 0xE6) return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 16) & 1;
+}
+#else
+static int cpuHasAVX2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+static int cpuHasAVX512(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+#endif
+
+#endif // TRANSFORM_X86
+
+// One kernel per fixed dimension, with the generic kernel in slot 0. The
+// tables are constant, so selecting one is a single pointer store that any
+// thread may race to make.
+typedef struct {
+    const char *name;
+    TransformKernel kernels[FIXED_DIM_MAX + 1];
+} TransformBackend;
+
+static const TransformBackend scalarBackend = {
+    "scalar", { transformScalar, transformScalar, transformScalar, transformScalar, transformScalar, transformScalar } };
+#ifdef TRANSFORM_X86
+static const TransformBackend sse2Backend = {
+    "sse2", { transformSSE2_N, transformScalar, transformScalar, transformSSE2_3, transformSSE2_4, transformSSE2_5 } };
+static const TransformBackend avx2Backend = {
+    "avx2", { transformAVX2_N, transformScalar, transformScalar, transformAVX2_3, transformAVX2_4, transformAVX2_5 } };
+static const TransformBackend avx512Backend = {
+    "avx512", { transformAVX512_N, transformScalar, transformScalar, transformAVX512_3, transformAVX512_4, transformAVX512_5 } };
+#endif
+
+static _Atomic(const TransformBackend *) backend;
+
+static const TransformBackend *currentBackend(void) {
+    const TransformBackend *selected = atomic_load_explicit(&backend, memory_order_acquire);
+    if (selected) return selected;
+    selected = &scalarBackend;
+#ifdef TRANSFORM_X86
+    if (cpuHasAVX512()) selected = &avx512Backend;
+    else if (cpuHasAVX2()) selected = &avx2Backend;
+    else selected = &sse2Backend;
+#endif
+    atomic_store_explicit(&backend, selected, memory_order_release);
+    return selected;
+}
+
+const char *transformBackendName(void) {
+    return currentBackend()->name;
+}
+
+void transformVerticesN(const float *m, const EdgeList *src, EdgeList *dst) {
+    const TransformBackend *selected = currentBackend();
+    int dim = src->dimension;
+    TransformKernel kernel = selected->kernels[dim <= FIXED_DIM_MAX ? dim : 0];
+    kernel(m, src->data, dst->data, src->stride, dim);
+}
@@ -0,0 +1,38 @@
+#include <triplebuffer.h>
+
+#define TRIPLE_BUFFER_FRESH 4u
+#define TRIPLE_BUFFER_INDEX 3u
+
+void tripleBufferInit(TripleBuffer *buffer) {
+    buffer->front = 0;
+    atomic_init(&buffer->middle, 1);
+    buffer->back = 2;
+}
+
+int tripleBufferBack(const TripleBuffer *buffer) {
+    return buffer->back;
+}
+
+void tripleBufferPublish(TripleBuffer *buffer) {
+    // Release hands the filled slot over; acquire takes back whichever slot
+    // the consumer last gave up, which it no longer reads
+    unsigned old = atomic_exchange_explicit(&buffer->middle, (unsigned)buffer->back | TRIPLE_BUFFER_FRESH, memory_order_acq_rel);
+    buffer->back = (int)(old & TRIPLE_BUFFER_INDEX);
+}
+
+int tripleBufferAcquire(TripleBuffer *buffer) {
+    // Only the consumer clears the flag, so once seen it stays set until the
+    // exchange below
+    if (!(atomic_load_explicit(&buffer->middle, memory_order_relaxed) & TRIPLE_BUFFER_FRESH)) return 0;
+    unsigned old = atomic_exchange_explicit(&buffer->middle, (unsigned)buffer->front, memory_order_acq_rel);
+    buffer->front = (int)(old & TRIPLE_BUFFER_INDEX);
+    return 1;
+}
+
+int tripleBufferFront(const TripleBuffer *buffer) {
+    return buffer->front;
+}
+
+int tripleBufferPending(TripleBuffer *buffer) {
+    return (atomic_load_explicit(&buffer->middle, memory_order_relaxed) & TRIPLE_BUFFER_FRESH) != 0;
+}
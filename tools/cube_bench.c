@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <cube3d.h>
+#include <math3d.h>
+#include <projection.h>
+#include <frame.h>
+#include <timer.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCH_HAS_TSC 1
+static unsigned long long benchCycles(void) { return __rdtsc(); }
+#else
+static unsigned long long benchCycles(void) { return 0; }
+#endif
+
+// Each sample times enough back-to-back calls to last at least this long
+#define BENCH_MIN_SAMPLE_SECONDS 200e-6
+#define BENCH_MAX_SAMPLES 1000
+
+typedef struct {
+    int dim;
+    EdgeList rest;     // the const cube table at 2^dim vertices, else random points
+    EdgeList out;
+    Proj *projected;
+    AngleList angles;
+    AngleList step;
+    Orientation orientation;
+    Camera camera;
+    float matrix[MAX_DIMENSION * MAX_DIMENSION];
+    float sink;
+} BenchContext;
+
+typedef void (*BenchFn)(BenchContext *ctx);
+
+typedef struct {
+    const char *name;
+    BenchFn fn;
+    int perVertex; // report per-vertex cost; otherwise per call
+    int onlyDim;   // 0 runs at every dimension
+} BenchKernel;
+
+static int warmupCalls = 20;
+static int sampleCount = 50;
+
+// The cube itself is a table lookup; its transformed copy is what a
+// dimension switch still allocates
+static void benchCreatePose(BenchContext *ctx) {
+    EdgeList pose = createPoseBuffer(cubeMesh(ctx->dim));
+    ctx->sink += pose.data[0];
+    freeVertexData(pose.data);
+}
+
+static void benchRotation3D(BenchContext *ctx) {
+    for (int axis = 0; axis < 3; axis++) {
+        getRotationMatrix3D(ctx->angles, ctx->matrix, axis);
+        ctx->sink += ctx->matrix[0];
+    }
+}
+
+static void benchRotation4D(BenchContext *ctx) {
+    for (int plane = 0; plane < 6; plane++) {
+        getRotationMatrix4D(ctx->angles, ctx->matrix, plane);
+        ctx->sink += ctx->matrix[0];
+    }
+}
+
+static void benchComposeRotation(BenchContext *ctx) {
+    frameComposeRotation(&ctx->angles, ctx->dim, ctx->matrix);
+    ctx->sink += ctx->matrix[0];
+}
+
+// What the frame loop does now: fold one small step in, read the matrix out
+static void benchOrientation(BenchContext *ctx) {
+    orientationAdvance(&ctx->orientation, &ctx->step);
+    orientationMatrix(&ctx->orientation, ctx->matrix);
+    ctx->sink += ctx->matrix[0];
+}
+
+static void benchMatrixMultiply(BenchContext *ctx) {
+    matrixMultiplyN(ctx->matrix, &ctx->out);
+}
+
+static void benchTransform(BenchContext *ctx) {
+    transformVerticesN(ctx->matrix, &ctx->rest, &ctx->out);
+}
+
+static void benchProjectOrtho(BenchContext *ctx) {
+    projectOrthoBatch(&ctx->camera, &ctx->out, ctx->projected);
+}
+
+static void benchProjectPerspective(BenchContext *ctx) {
+    frameProject(&ctx->camera, 1, &ctx->out, ctx->projected);
+}
+
+// The per-point path the batch projections replaced, for comparison
+static void benchProjectPerPoint(BenchContext *ctx) {
+    const EdgeList *v = &ctx->out;
+    Camera *c = &ctx->camera;
+    float pt[MAX_DIMENSION];
+    for (int i = 0; i < v->vertexCount; i++) {
+        for (int d = 0; d < v->dimension; d++) pt[d] = v->data[d * v->stride + i];
+        if (v->dimension == 3) ctx->projected[i] = projectPerspective3D(pt[0], pt[1], pt[2], c->screenW, c->screenH, 1.5f, 90.0f);
+        else projectHyperNto3D(pt, v->dimension, c->screenW, c->screenH, 1.5f, 90.0f, &ctx->projected[i], 1.5f, 90.0f);
+    }
+}
+
+static const BenchKernel kernels[] = {
+    { "createPoseBuffer", benchCreatePose, 1, 0 },
+    { "getRotationMatrix3D", benchRotation3D, 0, 3 },
+    { "getRotationMatrix4D", benchRotation4D, 0, 4 },
+    { "composeRotation", benchComposeRotation, 0, 0 },
+    { "orientationAdvance", benchOrientation, 0, 0 },
+    { "matrixMultiplyN", benchMatrixMultiply, 1, 0 },
+    { "transformVerticesN", benchTransform, 1, 0 },
+    { "projectOrthoBatch", benchProjectOrtho, 1, 0 },
+    { "projectPerspectiveBatch", benchProjectPerspective, 1, 0 },
+    { "projectPerPoint", benchProjectPerPoint, 1, 0 },
+};
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Unit-cube-sized random points so perspective stays clear of the near clamp
+static int contextInit(BenchContext *ctx, int dim, int vertexCount) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->dim = dim;
+    if (vertexCount == (1 << dim)) {
+        ctx->rest = *cubeMesh(dim);
+        ctx->out = createPoseBuffer(&ctx->rest);
+    } else {
+        int stride = vertexStrideFor(vertexCount);
+        ctx->rest = (EdgeList){ vertexCount, 0, dim, stride, allocVertexData(dim, stride), NULL };
+        ctx->out = (EdgeList){ vertexCount, 0, dim, stride, allocVertexData(dim, stride), NULL };
+        if (ctx->rest.data)
+            for (int i = 0; i < dim * stride; i++) ctx->rest.data[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+    ctx->projected = malloc(vertexCount * sizeof(Proj));
+    if (!ctx->rest.data || !ctx->out.data || !ctx->projected) return 0;
+
+    for (int p = 0; p < planeCount(dim); p++) {
+        ctx->angles.plane[p] = 0.1f * (p + 1);
+        ctx->step.plane[p] = 0.01f;
+    }
+    orientationReset(&ctx->orientation, dim);
+    frameComposeRotation(&ctx->angles, dim, ctx->matrix);
+    transformVerticesN(ctx->matrix, &ctx->rest, &ctx->out);
+    cameraUpdate(&ctx->camera, 800, 800, 0.5f, 1.5f, 90.0f, 1.5f, 90.0f);
+    return 1;
+}
+
+static void contextFree(BenchContext *ctx) {
+    if (ctx->rest.data != cubeMesh(ctx->dim)->data) freeVertexData(ctx->rest.data);
+    freeVertexData(ctx->out.data);
+    free(ctx->projected);
+}
+
+static void runKernel(const BenchKernel *kernel, BenchContext *ctx, int vertexCount) {
+    for (int i = 0; i < warmupCalls; i++) kernel->fn(ctx);
+
+    // Calibrate the number of calls per sample
+    int calls = 1;
+    for (;;) {
+        double start = timerNow();
+        for (int i = 0; i < calls; i++) kernel->fn(ctx);
+        if (timerNow() - start >= BENCH_MIN_SAMPLE_SECONDS || calls >= (1 << 24)) break;
+        calls *= 2;
+    }
+
+    double samples[BENCH_MAX_SAMPLES];
+    double cycleSamples[BENCH_MAX_SAMPLES];
+    for (int s = 0; s < sampleCount; s++) {
+        unsigned long long c0 = benchCycles();
+        double t0 = timerNow();
+        for (int i = 0; i < calls; i++) kernel->fn(ctx);
+        double t1 = timerNow();
+        unsigned long long c1 = benchCycles();
+        samples[s] = (t1 - t0) / calls;
+        cycleSamples[s] = (double)(c1 - c0) / calls;
+    }
+    qsort(samples, sampleCount, sizeof(double), compareDouble);
+    qsort(cycleSamples, sampleCount, sizeof(double), compareDouble);
+
+    double unit = kernel->perVertex ? vertexCount : 1;
+    printf("%-24s %4d %8d %12.3f %12.3f %12.2f %s\n", kernel->name, ctx->dim, vertexCount,
+           samples[0] * 1e9 / unit, samples[sampleCount / 2] * 1e9 / unit,
+           cycleSamples[sampleCount / 2] / unit, kernel->perVertex ? "vertex" : "call");
+}
+
+static void runSuite(int dim, int vertexCount, int cubeOnly) {
+    BenchContext ctx;
+    if (!contextInit(&ctx, dim, vertexCount)) {
+        fprintf(stderr, "Allocation failed for dim %d, %d vertices\n", dim, vertexCount);
+        contextFree(&ctx);
+        return;
+    }
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        const BenchKernel *kernel = &kernels[k];
+        if (kernel->onlyDim && kernel->onlyDim != dim) continue;
+        // The vertex-count sweeps only cover the streaming kernels
+        if (!cubeOnly && (!kernel->perVertex || kernel->fn == benchCreatePose)) continue;
+        runKernel(kernel, &ctx, vertexCount);
+    }
+    // Keep the sink observable so nothing is optimized away
+    if (ctx.sink == 12345.678f) printf(" ");
+    contextFree(&ctx);
+}
+
+static void usage(void) {
+    printf("usage: cube-bench [--max-dim N] [--samples N] [--warmup N] [--vertices N ...]\n");
+}
+
+int main(int argc, char **argv) {
+    int maxDim = MAX_DIMENSION;
+    int vertexCounts[16] = { 1024, 16384, 262144 };
+    int vertexCountCount = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--max-dim") && i + 1 < argc) maxDim = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--samples") && i + 1 < argc) sampleCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) warmupCalls = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--vertices") && i + 1 < argc) {
+            vertexCountCount = 0;
+            while (i + 1 < argc && argv[i + 1][0] != '-' && vertexCountCount < 16)
+                vertexCounts[vertexCountCount++] = atoi(argv[++i]);
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (maxDim < 3 || maxDim > MAX_DIMENSION || sampleCount < 1 || sampleCount > BENCH_MAX_SAMPLES || warmupCalls < 0) {
+        fprintf(stderr, "max-dim must be 3..%d and samples 1..%d\n", MAX_DIMENSION, BENCH_MAX_SAMPLES);
+        return EXIT_FAILURE;
+    }
+
+    printf("transform backend: %s\n", transformBackendName());
+#ifndef BENCH_HAS_TSC
+    printf("no cycle counter on this target; cycles column is 0\n");
+#endif
+    printf("%-24s %4s %8s %12s %12s %12s\n", "kernel", "dim", "verts", "min ns", "median ns", "cycles");
+
+    // Hypercube geometry at each dimension
+    for (int dim = 3; dim <= maxDim; dim++) runSuite(dim, 1 << dim, 1);
+
+    // Streaming kernels over larger vertex counts
+    for (int v = 0; v < vertexCountCount; v++) {
+        if (vertexCounts[v] < 1) continue;
+        for (int dim = 3; dim <= maxDim; dim++) runSuite(dim, vertexCounts[v], 0);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <cube3d.h>
+#include <math3d.h>
+#include <polytope.h>
+
+// Everything but the cube is scaled to the 3-cube's circumradius so the
+// default camera frames it the same way
+#define CIRCUMRADIUS 0.8660254
+// Pairs this close to the shortest distance count as edges
+#define EDGE_TOLERANCE 1e-6
+
+typedef struct {
+    int dim, count, capacity;
+    double *pts; // count points of dim coordinates
+} PointSet;
+
+static int addPoint(PointSet *set, const double *p) {
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 64;
+        double *grown = realloc(set->pts, (size_t)capacity * set->dim * sizeof(double));
+        if (!grown) return 0;
+        set->pts = grown;
+        set->capacity = capacity;
+    }
+    memcpy(set->pts + (size_t)set->count++ * set->dim, p, set->dim * sizeof(double));
+    return 1;
+}
+
+static double distanceSquared(const PointSet *set, int a, int b) {
+    double sum = 0.0;
+    for (int d = 0; d < set->dim; d++) {
+        double delta = set->pts[a * set->dim + d] - set->pts[b * set->dim + d];
+        sum += delta * delta;
+    }
+    return sum;
+}
+
+// Regular polytopes have all edges at the shortest vertex distance, so the
+// edges are exactly the pairs found there. Quadratic, but only run offline.
+static EdgeList meshFromPoints(const PointSet *set) {
+    EdgeList mesh = {0};
+    int n = set->count, dim = set->dim;
+
+    double radius = 0.0;
+    for (int i = 0; i < n; i++) {
+        double r = 0.0;
+        for (int d = 0; d < dim; d++) r += set->pts[i * dim + d] * set->pts[i * dim + d];
+        if (r > radius) radius = r;
+    }
+    double scale = CIRCUMRADIUS / sqrt(radius);
+
+    double shortest = INFINITY;
+    for (int a = 0; a < n; a++)
+        for (int b = a + 1; b < n; b++) {
+            double d2 = distanceSquared(set, a, b);
+            if (d2 < shortest) shortest = d2;
+        }
+    int edgeCount = 0;
+    for (int a = 0; a < n; a++)
+        for (int b = a + 1; b < n; b++)
+            if (distanceSquared(set, a, b) <= shortest * (1.0 + EDGE_TOLERANCE)) edgeCount++;
+
+    int stride = vertexStrideFor(n);
+    mesh.data = allocVertexData(dim, stride);
+    mesh.edges = malloc((size_t)edgeCount * 2 * sizeof(int));
+    if (!mesh.data || !mesh.edges) {
+        freeEdgeList(&mesh);
+        return mesh;
+    }
+    for (int i = 0; i < n; i++)
+        for (int d = 0; d < dim; d++) mesh.data[d * stride + i] = (float)(set->pts[i * dim + d] * scale);
+    int e = 0;
+    for (int a = 0; a < n; a++)
+        for (int b = a + 1; b < n; b++)
+            if (distanceSquared(set, a, b) <= shortest * (1.0 + EDGE_TOLERANCE)) {
+                mesh.edges[e * 2 + 0] = a;
+                mesh.edges[e * 2 + 1] = b;
+                e++;
+            }
+    mesh.vertexCount = n;
+    mesh.edgeCount = edgeCount;
+    mesh.dimension = dim;
+    mesh.stride = stride;
+    return mesh;
+}
+
+// The basis vectors plus one point on the diagonal at the same distance
+// from each of them
+static int simplexPoints(PointSet *set) {
+    int dim = set->dim;
+    double p[MAX_DIMENSION];
+    for (int i = 0; i < dim; i++) {
+        memset(p, 0, sizeof(p));
+        p[i] = 1.0;
+        if (!addPoint(set, p)) return 0;
+    }
+    double a = (1.0 - sqrt(dim + 1.0)) / dim;
+    for (int d = 0; d < dim; d++) p[d] = a;
+    if (!addPoint(set, p)) return 0;
+
+    // Centre on the origin
+    double centre[MAX_DIMENSION] = {0};
+    for (int i = 0; i < set->count; i++)
+        for (int d = 0; d < dim; d++) centre[d] += set->pts[i * dim + d] / set->count;
+    for (int i = 0; i < set->count; i++)
+        for (int d = 0; d < dim; d++) set->pts[i * dim + d] -= centre[d];
+    return 1;
+}
+
+static int crossPoints(PointSet *set) {
+    double p[MAX_DIMENSION];
+    for (int i = 0; i < set->dim; i++)
+        for (int sign = -1; sign <= 1; sign += 2) {
+            memset(p, 0, sizeof(p));
+            p[i] = sign;
+            if (!addPoint(set, p)) return 0;
+        }
+    return 1;
+}
+
+// Permutations of (+-1, +-1, 0, 0)
+static int points24Cell(PointSet *set) {
+    for (int i = 0; i < 4; i++)
+        for (int j = i + 1; j < 4; j++)
+            for (int signs = 0; signs < 4; signs++) {
+                double p[4] = {0};
+                p[i] = signs & 1 ? -1.0 : 1.0;
+                p[j] = signs & 2 ? -1.0 : 1.0;
+                if (!addPoint(set, p)) return 0;
+            }
+    return 1;
+}
+
+// The unit icosians: (+-1, 0, 0, 0) permuted, (+-1/2, +-1/2, +-1/2, +-1/2)
+// and even permutations of (+-phi, +-1, +-1/phi, 0) / 2
+static int points600Cell(PointSet *set) {
+    double phi = (1.0 + sqrt(5.0)) * 0.5;
+    for (int i = 0; i < 4; i++)
+        for (int sign = -1; sign <= 1; sign += 2) {
+            double p[4] = {0};
+            p[i] = sign;
+            if (!addPoint(set, p)) return 0;
+        }
+    for (int signs = 0; signs < 16; signs++) {
+        double p[4];
+        for (int d = 0; d < 4; d++) p[d] = signs & (1 << d) ? -0.5 : 0.5;
+        if (!addPoint(set, p)) return 0;
+    }
+
+    double base[4] = { phi * 0.5, 0.5, 0.5 / phi, 0.0 };
+    for (int a = 0; a < 4; a++)
+        for (int b = 0; b < 4; b++)
+            for (int c = 0; c < 4; c++) {
+                int d = 6 - a - b - c;
+                if (a == b || a == c || b == c || d < 0 || d > 3 || d == a || d == b || d == c) continue;
+                int perm[4] = { a, b, c, d }, inversions = 0;
+                for (int i = 0; i < 4; i++)
+                    for (int j = i + 1; j < 4; j++) inversions += perm[i] > perm[j];
+                if (inversions & 1) continue;
+                for (int signs = 0; signs < 8; signs++) {
+                    double p[4];
+                    for (int k = 0; k < 4; k++) p[perm[k]] = base[k];
+                    for (int k = 0; k < 3; k++)
+                        if (signs & (1 << k)) p[perm[k]] = -p[perm[k]];
+                    if (!addPoint(set, p)) return 0;
+                }
+            }
+    return 1;
+}
+
+// The dual of the 600-cell: one vertex at the centre of each of its 600
+// tetrahedral cells, found as the 4-cliques of its edge graph
+static int points120Cell(PointSet *set) {
+    PointSet icosians = { 4, 0, 0, NULL };
+    if (!points600Cell(&icosians)) {
+        free(icosians.pts);
+        return 0;
+    }
+    EdgeList cells = meshFromPoints(&icosians);
+    if (!cells.data) {
+        free(icosians.pts);
+        return 0;
+    }
+    int n = icosians.count;
+    unsigned char *adjacent = calloc((size_t)n * n, 1);
+    int ok = adjacent != NULL;
+    for (int e = 0; ok && e < cells.edgeCount; e++) {
+        int a = cells.edges[e * 2], b = cells.edges[e * 2 + 1];
+        adjacent[a * n + b] = adjacent[b * n + a] = 1;
+    }
+    for (int a = 0; ok && a < n; a++)
+        for (int b = a + 1; ok && b < n; b++) {
+            if (!adjacent[a * n + b]) continue;
+            for (int c = b + 1; ok && c < n; c++) {
+                if (!adjacent[a * n + c] || !adjacent[b * n + c]) continue;
+                for (int d = c + 1; ok && d < n; d++) {
+                    if (!adjacent[a * n + d] || !adjacent[b * n + d] || !adjacent[c * n + d]) continue;
+                    double p[4];
+                    for (int k = 0; k < 4; k++)
+                        p[k] = icosians.pts[a * 4 + k] + icosians.pts[b * 4 + k] + icosians.pts[c * 4 + k] + icosians.pts[d * 4 + k];
+                    ok = addPoint(set, p);
+                }
+            }
+        }
+    free(adjacent);
+    freeEdgeList(&cells);
+    free(icosians.pts);
+    return ok;
+}
+
+typedef struct {
+    const char *name;
+    int fixedDim;           // 0 takes --dimension
+    int (*points)(PointSet *set);
+} Generator;
+
+static const Generator generators[] = {
+    { "cube", 0, NULL },
+    { "simplex", 0, simplexPoints },
+    { "cross", 0, crossPoints },
+    { "24-cell", 4, points24Cell },
+    { "600-cell", 4, points600Cell },
+    { "120-cell", 4, points120Cell },
+};
+
+static int expectedEdges(const char *name, int dim) {
+    if (!strcmp(name, "cube")) return dim << (dim - 1);
+    if (!strcmp(name, "simplex")) return dim * (dim + 1) / 2;
+    if (!strcmp(name, "cross")) return 2 * dim * (dim - 1);
+    if (!strcmp(name, "24-cell")) return 96;
+    if (!strcmp(name, "600-cell")) return 720;
+    return 1200;
+}
+
+static void usage(void) {
+    printf("usage: cube-polytope <cube|simplex|cross|24-cell|600-cell|120-cell> [--dimension N] <output>\n");
+}
+
+int main(int argc, char **argv) {
+    const Generator *gen = NULL;
+    const char *output = NULL;
+    int dim = 4;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--dimension") && i + 1 < argc) dim = atoi(argv[++i]);
+        else if (!gen) {
+            for (size_t g = 0; g < sizeof(generators) / sizeof(generators[0]); g++)
+                if (!strcmp(argv[i], generators[g].name)) gen = &generators[g];
+            if (!gen) {
+                usage();
+                return EXIT_FAILURE;
+            }
+        } else if (!output) output = argv[i];
+        else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (!gen || !output) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    if (gen->fixedDim && dim != gen->fixedDim) {
+        fprintf(stderr, "%s is only defined in dimension %d\n", gen->name, gen->fixedDim);
+        return EXIT_FAILURE;
+    }
+    if (dim < 3 || dim > MAX_DIMENSION) {
+        fprintf(stderr, "dimension must be 3..%d\n", MAX_DIMENSION);
+        return EXIT_FAILURE;
+    }
+
+    // The cube comes straight from the built-in tables and is not freed
+    EdgeList mesh = {0};
+    if (!gen->points) mesh = *cubeMesh(dim);
+    else {
+        PointSet set = { dim, 0, 0, NULL };
+        if (gen->points(&set)) mesh = meshFromPoints(&set);
+        free(set.pts);
+    }
+    if (!mesh.data) {
+        fprintf(stderr, "Failed to build %s\n", gen->name);
+        return EXIT_FAILURE;
+    }
+    if (mesh.edgeCount != expectedEdges(gen->name, dim)) {
+        fprintf(stderr, "%s came out with %d edges instead of %d\n", gen->name, mesh.edgeCount, expectedEdges(gen->name, dim));
+        if (gen->points) freeEdgeList(&mesh);
+        return EXIT_FAILURE;
+    }
+
+    char name[16];
+    if (gen->fixedDim) snprintf(name, sizeof(name), "%s", gen->name);
+    else snprintf(name, sizeof(name), "%s-%d", gen->name, dim);
+    int ok = polytopeWrite(&mesh, name, output);
+    if (ok) printf("%s: %d-D, %d vertices, %d edges -> %s\n", name, dim, mesh.vertexCount, mesh.edgeCount, output);
+    else fprintf(stderr, "Failed to write %s\n", output);
+    if (gen->points) freeEdgeList(&mesh);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <types.h>
+#include <math3d.h>
+
+// Build-time generator for the n-cube tables behind cubeMesh: writes a C
+// source holding, for every dimension 3..MAX_DIMENSION, the vertices in the
+// padded SoA layout of allocVertexData and the edge index pairs, all const
+// so they land in read-only data. Vertex v has coordinate d at +0.5 when bit
+// d of v is set, and its edges run to the neighbours differing in one bit.
+#define VALUES_PER_LINE 32
+
+static int stride(int vertexCount) {
+    return (vertexCount + VERTEX_STRIDE_MULTIPLE - 1) / VERTEX_STRIDE_MULTIPLE * VERTEX_STRIDE_MULTIPLE;
+}
+
+// Breaks the initializer into lines as values are written
+static void separator(FILE *out, int index, int count) {
+    if (index == count - 1) fputc('\n', out);
+    else fputs((index + 1) % VALUES_PER_LINE ? ", " : ",\n    ", out);
+}
+
+static void writeDimension(FILE *out, int dim) {
+    int verts = 1 << dim, edges = dim << (dim - 1), s = stride(verts);
+
+    fprintf(out, "// %d-cube: %d vertices, %d edges\n", dim, verts, edges);
+    fprintf(out, "static _Alignas(VERTEX_ALIGNMENT) const float vertices%d[%d * %d] = {\n    ", dim, dim, s);
+    for (int d = 0; d < dim; d++)
+        for (int v = 0; v < s; v++) {
+            // Padding lanes stay zero, as allocVertexData leaves them
+            fputs(v >= verts ? "0" : v & (1 << d) ? "H" : "L", out);
+            separator(out, d * s + v, dim * s);
+        }
+    fprintf(out, "};\n");
+
+    fprintf(out, "static const int edges%d[%d * 2] = {\n    ", dim, edges);
+    int written = 0;
+    for (int v = 0; v < verts; v++)
+        for (int d = 0; d < dim; d++) {
+            int neighbour = v ^ (1 << d);
+            if (v > neighbour) continue;
+            fprintf(out, "%d", v);
+            separator(out, written++, edges * 2);
+            fprintf(out, "%d", neighbour);
+            separator(out, written++, edges * 2);
+        }
+    fprintf(out, "};\n");
+    fprintf(out, "_Static_assert(%d == (%d + VERTEX_STRIDE_MULTIPLE - 1) / VERTEX_STRIDE_MULTIPLE * VERTEX_STRIDE_MULTIPLE,\n"
+                 "               \"cube tables were generated for another vertex stride\");\n\n", s, verts);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("usage: cube-tables <output.c>\n");
+        return EXIT_FAILURE;
+    }
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "// Generated at build time by cube-tables (tools/cube_tables.c). Do not edit.\n\n");
+    fprintf(out, "#include <cube3d.h>\n#include <math3d.h>\n\n");
+    fprintf(out, "_Static_assert(MAX_DIMENSION == %d, \"cube tables were generated for another MAX_DIMENSION\");\n\n", MAX_DIMENSION);
+    fprintf(out, "#define L -0.5f\n#define H 0.5f\n\n");
+    for (int dim = 3; dim <= MAX_DIMENSION; dim++) writeDimension(out, dim);
+    fprintf(out, "#undef L\n#undef H\n\n");
+
+    // EdgeList has mutable pointers for the buffers it also describes; these
+    // ones point into read-only data and are never written
+    fprintf(out, "const EdgeList cubeTables[MAX_DIMENSION + 1] = {\n");
+    for (int dim = 3; dim <= MAX_DIMENSION; dim++)
+        fprintf(out, "    [%d] = { %d, %d, %d, %d, (float *)vertices%d, (int *)edges%d },\n",
+                dim, 1 << dim, dim << (dim - 1), dim, stride(1 << dim), dim, dim);
+    fprintf(out, "};\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}